@@ -8,10 +8,12 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <cmath>
 #include <vector>
 #include <tuple>
 #include <queue>
+#include <numeric>
 #include <algorithm>
 #include <cassert>
 
@@ -147,6 +149,38 @@ const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
 //  Simulation parameters
 const double dT = 0.1;
 
+//  pose = ( u[m], v[m], q[rad] )
+using pose = std::tuple< double, double, double >;
+
+/**
+ * @fn resimulate
+ * @brief simulate actions continuously from a start pose
+ * @param [in] start a start pose
+ * @param [in] actions indices of W
+ * @return poses after every action, the first of which is a start pose
+ * @details angles are a prefix sum of rotations, and positions are prefix sums of translations at mean angles,
+ *          so that steps do not depend on each other except for the prefix sums
+ */
+std::vector< pose > resimulate( const pose& start, const std::vector< int >& actions ) {
+    const std::size_t n = actions.size( );
+    auto [ u_start, v_start, q_start ] = start;
+    std::vector< double > q( n + 1, q_start ), u( n + 1, u_start ), v( n + 1, v_start );
+    std::transform( actions.begin( ), actions.end( ), q.begin( ) + 1, []( int a ) { return W.at( a ) * dT; } );
+    std::partial_sum( q.begin( ), q.end( ), q.begin( ) );
+    for( std::size_t k = 0; k < n; k++ ) {
+        u[ k + 1 ] = V * dT * std::cos( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+        v[ k + 1 ] = V * dT * std::sin( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+    }
+    std::partial_sum( u.begin( ), u.end( ), u.begin( ) );
+    std::partial_sum( v.begin( ), v.end( ), v.begin( ) );
+
+    std::vector< pose > poses( n + 1 );
+    for( std::size_t k = 0; k <= n; k++ ) {
+        poses[ k ] = pose( u[ k ], v[ k ], q[ k ] );
+    }
+    return poses;
+}
+
 //  state = ( u_id, v_id, q_id )
 using state = std::tuple< int, int, int >;
 std::ostream& operator<<( std::ostream& os, const state& s ) {
@@ -217,6 +251,29 @@ int q_id( double q ) { return ( int ) std::floor( ( q - q_min ) / d_q ); }
  */
 double q_val( int q_id ) { return ( double ) q_id * d_q + ( q_min + d_q / 2.0 ); }
 
+/**
+ * @fn action_id
+ * @brief find an index of W which turns q_id_prev into q_id_curr
+ * @param [in] q_id_prev, q_id_curr ids of angles of a previous state and a state
+ * @return an index of W
+ * @details an action is recovered from a previous state, instead of being stored for each state
+ */
+int action_id( int q_id_prev, int q_id_curr ) {
+    for( std::size_t a = 0; a < W.size( ); a++ ) {
+        double q_next = q_val( q_id_prev ) + W.at( a ) * dT;
+        if( q_next < q_min ) {
+            q_next += 2.0 * M_PI;
+        } else if( q_max <= q_next ) {
+            q_next -= 2.0 * M_PI;
+        }
+        if( q_id( q_next ) == q_id_curr ) {
+            return ( int ) a;
+        }
+    }
+    assert( false );
+    return -1;
+}
+
 int main( ) {
     //  Constants
     const int u_size = u_id( u_max ) + 1, v_size = v_id( v_max ) + 1, q_size = q_id( q_max );
@@ -253,9 +310,9 @@ int main( ) {
         }
 
         //  Take a rotation speed w out of W
-        for( auto w : W ) {
+        for( std::size_t a = 0; a < W.size( ); a++ ) {
             //  Next state
-            double q_next = q_curr + w * dT;
+            double q_next = q_curr + W.at( a ) * dT;
             if( q_next < q_min ) {
                 q_next += 2.0 * M_PI;
             } else if( q_max <= q_next ) {
@@ -287,10 +344,12 @@ int main( ) {
 
     //  Retrieve a path
     std::vector< state > path_state;
+    std::vector< int > path_action;
     int u_id_curr = u_id( u_goal ), v_id_curr = v_id( v_goal ), q_id_curr = q_id( q_goal );
     while( !( u_id_curr == u_id( u_start ) && ( v_id_curr == v_id( v_start ) ) && q_id_curr == q_id( q_start ) ) ) {
         path_state.push_back( state( u_id_curr, v_id_curr, q_id_curr ) );
         auto [ u, v, q ] = prev.at( u_id_curr ).at( v_id_curr ).at( q_id_curr );
+        path_action.push_back( action_id( q, q_id_curr ) );
         u_id_curr = u;
         v_id_curr = v;
         q_id_curr = q;
@@ -300,6 +359,7 @@ int main( ) {
     }
     path_state.push_back( state( u_id_curr, v_id_curr, q_id_curr ) );
     std::reverse( path_state.begin( ), path_state.end( ) );
+    std::reverse( path_action.begin( ), path_action.end( ) );
 
     //  Outout a path as ( u, v, du, dv )
     //  Outout a path as ( u, v, q, V )
@@ -309,5 +369,19 @@ int main( ) {
         std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << q << " " << V << std::endl;
     }
 
+    //  Output actions to actions.txt as "ok <n> <actions> <error position> <error angle>" of iwata-07,
+    //  actions are n digits of indices of W, "-" if n is 0, and an error is of an end pose by a continuous simulation
+    auto [ u_end, v_end, q_end ] = resimulate( { u_start, v_start, q_start }, path_action ).back( );
+    double q_err = std::remainder( q_end - q_goal, 2.0 * M_PI );
+    std::ofstream ofs( "actions.txt" );
+    ofs << "ok " << path_action.size( ) << " ";
+    for( auto a : path_action ) {
+        ofs << a;
+    }
+    ofs << ( path_action.empty( ) ? "- " : " " ) << std::fixed << std::setprecision( 4 )
+        << std::hypot( u_end - u_goal, v_end - v_goal ) << " " << std::fabs( q_err ) << std::endl;
+    std::cerr << std::fixed << std::setprecision( 3 ) << "end: ( " << u_end << ", " << v_end << ", " << q_end << " )"
+              << std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -8,10 +8,19 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <cmath>
 #include <vector>
 #include <tuple>
 #include <queue>
+#include <atomic>
+#include <limits>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <algorithm>
 #include <cassert>
 
@@ -83,7 +92,6 @@ const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
 
 //  Data Set
 //  Offset
-const double d_u = 0.005;
 const double offset_u = ( std::floor( V / deg2rad( 30.0 ) * 1000.0 ) + 1.0 ) / 1000.0;
 //  { Start, Goal }
 using uvq = std::tuple< double, double, double >;
@@ -97,18 +105,40 @@ const std::vector< std::pair< uvq, uvq > > starts_goals_uvq = {
     { { 3.726, 0.000, deg2rad( 150.0 ) }, { 2.484, 0.600, deg2rad( 180.0 ) } },
     { { 2.484, 0.600, deg2rad( 180.0 ) }, { 1.863, 0.000, deg2rad( 270.0 ) } } };
 
-//  Range of v-position [ v_min, v_max )
-const double d_v = 0.005;
-const std::pair< double, double > v_range = { -1.200 - d_v / 2.0, 1.200 + 3.0 * d_v / 2.0 };
+//  Range of v-position of the course [ v_min, v_max ]
+const std::pair< double, double > course_v = { -1.200, 1.200 };
 
-//  Range of angle [ q_min, q_max )
-const double d_q = M_PI / 60.0;
-const std::pair< double, double > q_range = { 0.0 - d_q / 2.0, 2.0 * M_PI - d_q / 2.0 };
+//  Resolution ( d_u, d_v, d_q ) of a leg, unless it is given by a configuration of iwata-08
+using resolution = std::tuple< double, double, double >;
+const resolution default_resolution = { 0.005, 0.005, M_PI / 60.0 };
 
 //  Constants
 //  INF for time
 const double INF = 1e6;
 
+//  pose = ( u, v, q )
+using pose = std::tuple< double, double, double >;
+
+/**
+ * @fn resimulate
+ * @brief simulate actions continuously from a start pose
+ * @param [in] start a start pose
+ * @param [in] actions indices of W
+ * @param [in] n the number of actions
+ * @return an end pose
+ * @details the same simulation as iwata-03, summed in the same order, without heap allocations
+ */
+pose resimulate( const pose& start, const std::uint8_t* actions, std::size_t n ) {
+    auto [ u, v, q ] = start;
+    for( std::size_t k = 0; k < n; k++ ) {
+        double q_next = q + W[ actions[ k ] ] * dT;
+        u += V * dT * std::cos( ( q + q_next ) / 2.0 );
+        v += V * dT * std::sin( ( q + q_next ) / 2.0 );
+        q = q_next;
+    }
+    return { u, v, q };
+}
+
 //  state = ( u_id, v_id, q_id )
 using state = std::tuple< int, int, int >;
 std::ostream& operator<<( std::ostream& os, const state& s ) {
@@ -132,7 +162,7 @@ std::ostream& operator<<( std::ostream& os, const entry& e ) {
  * @return id
  * @details requires u_min and d_u
  */
-// int u_id( double u ) { return ( int ) std::floor( ( u - u_min ) / d_u ); }
+int u_id( double u, double u_min, double d_u ) { return ( int ) std::floor( ( u - u_min ) / d_u ); }
 
 /**
  * @fn u_val
@@ -141,7 +171,7 @@ std::ostream& operator<<( std::ostream& os, const entry& e ) {
  * @return position of u [m]
  * @details requires u_min and d_u
  */
-// double u_val( int u_id ) { return ( double ) u_id * d_u + u_min + d_u / 2.0; }
+double u_val( int u_id, double u_min, double d_u ) { return ( double ) u_id * d_u + u_min + d_u / 2.0; }
 
 /**
  * @fn v_id
@@ -150,7 +180,7 @@ std::ostream& operator<<( std::ostream& os, const entry& e ) {
  * @return id
  * @details requires v_min and d_v
  */
-// int v_id( double v ) { return ( int ) std::floor( ( v - v_min ) / d_v ); }
+int v_id( double v, double v_min, double d_v ) { return ( int ) std::floor( ( v - v_min ) / d_v ); }
 
 /**
  * @fn v_val
@@ -159,7 +189,7 @@ std::ostream& operator<<( std::ostream& os, const entry& e ) {
  * @return position of v [m]
  * @details requires v_min and d_v
  */
-// double v_val( int v_id ) { return ( double ) v_id * d_v + ( v_min + d_v / 2.0 ); }
+double v_val( int v_id, double v_min, double d_v ) { return ( double ) v_id * d_v + ( v_min + d_v / 2.0 ); }
 
 /**
  * @fn q_id
@@ -179,20 +209,365 @@ int q_id( double q, double q_min, double d_q ) { return ( int ) std::floor( ( q
  */
 double q_val( int q_id, double q_min, double d_q ) { return ( double ) q_id * d_q + ( q_min + d_q / 2.0 ); }
 
-int main( ) {
+//  The number of heap allocations, counted by the replaced global operator new
+std::atomic< std::size_t > num_allocations( 0 );
+void* operator new( std::size_t size ) {
+    num_allocations++;
+    if( void* p = std::malloc( size > 0 ? size : 1 ) ) {
+        return p;
+    }
+    throw std::bad_alloc( );
+}
+//  GCC pairs the inlined free with operator new and warns as -Wmismatched-new-delete, which is a false positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete( void* p ) noexcept { std::free( p ); }
+#pragma GCC diagnostic pop
+void operator delete( void* p, std::size_t ) noexcept { operator delete( p ); }
+
+/**
+ * @class arena
+ * @brief a bump allocator on a caller-provided buffer
+ * @details memory is never freed one by one, but all at once by reset( ),
+ *          and std::bad_alloc is thrown if a buffer is exhausted
+ */
+class arena {
+  public:
+    arena( void* buffer, std::size_t size ) : base( static_cast< char* >( buffer ) ), size( size ), used( 0 ) {}
+    template < class T >
+    T* allocate( std::size_t n ) {
+        std::size_t begin = ( used + alignof( T ) - 1 ) / alignof( T ) * alignof( T );
+        //  An overflow of a buffer fails as an allocation, not as a write past it
+        if( begin > size || n > ( size - begin ) / sizeof( T ) ) {
+            throw std::bad_alloc( );
+        }
+        used = begin + n * sizeof( T );
+        return reinterpret_cast< T* >( base + begin );
+    }
+    void reset( ) { used = 0; }
+    std::size_t bytes_used( ) const { return used; }
+
+  private:
+    char* base;
+    std::size_t size;
+    std::size_t used;
+};
+
+/**
+ * @struct window
+ * @brief a grid of a leg, [ u_min, u_max ) x [ v_min, v_max ) x [ q_min, q_max ) by a resolution of the leg
+ * @details u is around a leg by offset_u, v is the whole course,
+ *          and a state is a flat id of ( u_id * v_size + v_id ) * q_size + q_id
+ */
+struct window {
+    double d_u, d_v, d_q;
+    std::pair< double, double > u_range, v_range, q_range;
+    int u_size, v_size, q_size;
+    window( const uvq& start_uvq, const uvq& goal_uvq, const resolution& r ) {
+        std::tie( d_u, d_v, d_q ) = r;
+        auto [ start_u, start_v, start_q ] = start_uvq;
+        auto [ goal_u, goal_v, goal_q ] = goal_uvq;
+        double u_min = std::min( start_u, goal_u ) - offset_u, u_max = std::max( start_u, goal_u ) + offset_u;
+        u_range = { u_min - d_u / 2.0, u_max + 3.0 * d_u / 2.0 };
+        v_range = { course_v.first - d_v / 2.0, course_v.second + 3.0 * d_v / 2.0 };
+        q_range = { 0.0 - d_q / 2.0, 2.0 * M_PI - d_q / 2.0 };
+        u_size = u_id( u_range.second, u_range.first, d_u );
+        v_size = v_id( v_range.second, v_range.first, d_v );
+        q_size = q_id( q_range.second, q_range.first, d_q );
+    }
+    std::size_t size( ) const { return ( std::size_t ) u_size * v_size * q_size; }
+    //  An estimate of the peak of a priority queue, see search_core
+    std::size_t frontier_size( ) const {
+        const std::size_t thickness = ( std::size_t ) std::ceil( V * dT / std::min( d_u, d_v ) );
+        return std::min( size( ), 2 * thickness * 2 * ( std::size_t )( u_size + v_size ) * q_size );
+    }
+    std::uint32_t flat_id( int u, int v, int q ) const { return ( u * v_size + v ) * q_size + q; }
+    state ids( std::uint32_t id ) const { return { id / q_size / v_size, ( id / q_size ) % v_size, id % q_size }; }
+};
+
+/**
+ * @fn next_q
+ * @brief an angle after an action
+ * @param [in] w a window
+ * @param [in] q an angle
+ * @param [in] a an index of W
+ * @return an angle in [ q_min, q_max ) of w
+ * @details
+ */
+double next_q( const window& w, double q, std::size_t a ) {
+    double q_next = q + W[ a ] * dT;
+    if( q_next < w.q_range.first ) {
+        q_next += 2.0 * M_PI;
+    } else if( w.q_range.second <= q_next ) {
+        q_next -= 2.0 * M_PI;
+    }
+    return q_next;
+}
+
+/**
+ * @struct search_core
+ * @brief tables, a priority queue and a path buffer of Dijkstra's search, taken from an arena
+ * @details a state is valid only if its stamp is the current generation,
+ *          so that a reset between searches costs nothing instead of clearing tables.
+ *          A state is pushed only when its cost decreases, which is once by a unit cost of an action,
+ *          so that a queue holds a wavefront of two costs, t and t + 1. A wavefront of a cost is estimated
+ *          as long as the perimeter of a window for each heading, and as thick as cells passed by a step,
+ *          which is window::frontier_size( ). A push beyond a capacity fails instead of growing a queue.
+ */
+struct search_core {
+    //  Tables of states
+    std::size_t capacity;
+    std::uint32_t* stamp;
+    std::uint16_t* g_cost;
+    std::uint32_t* prev;
+    std::uint32_t generation;
+    //  Priority queue as a binary heap of ( cost << 32 ) | id
+    std::uint64_t* heap;
+    std::size_t heap_capacity, heap_size, heap_peak;
+    //  Path buffer from start to goal
+    std::uint32_t* path_id;
+    std::uint8_t* path_action;
+    std::size_t path_capacity, path_size;
+
+    search_core( arena& a, std::size_t num_states, std::size_t num_entries, std::size_t num_steps )
+        : capacity( num_states ),
+          stamp( a.allocate< std::uint32_t >( num_states ) ),
+          g_cost( a.allocate< std::uint16_t >( num_states ) ),
+          prev( a.allocate< std::uint32_t >( num_states ) ),
+          generation( 0 ),
+          heap( a.allocate< std::uint64_t >( num_entries ) ),
+          heap_capacity( num_entries ),
+          heap_size( 0 ),
+          heap_peak( 0 ),
+          path_id( a.allocate< std::uint32_t >( num_steps + 1 ) ),
+          path_action( a.allocate< std::uint8_t >( num_steps ) ),
+          path_capacity( num_steps + 1 ),
+          path_size( 0 ) {
+        std::fill( stamp, stamp + capacity, 0 );
+    }
+    void reset( ) {
+        heap_size = 0;
+        heap_peak = 0;
+        path_size = 0;
+        //  Stamps are cleared only when a generation wraps around
+        if( ++generation == 0 ) {
+            std::fill( stamp, stamp + capacity, 0 );
+            generation = 1;
+        }
+    }
+    bool is_visited( std::uint32_t id ) const { return stamp[ id ] == generation; }
+    bool push( std::uint16_t cost, std::uint32_t id ) {
+        if( heap_size == heap_capacity ) {
+            return false;
+        }
+        heap[ heap_size++ ] = ( std::uint64_t( cost ) << 32 ) | id;
+        std::push_heap( heap, heap + heap_size, std::greater< std::uint64_t >( ) );
+        heap_peak = std::max( heap_peak, heap_size );
+        return true;
+    }
+    std::pair< std::uint16_t, std::uint32_t > pop( ) {
+        std::pop_heap( heap, heap + heap_size, std::greater< std::uint64_t >( ) );
+        std::uint64_t e = heap[ --heap_size ];
+        return { ( std::uint16_t )( e >> 32 ), ( std::uint32_t )( e & 0xffffffffu ) };
+    }
+};
+
+/**
+ * @fn search
+ * @brief Dijkstra's search of a leg without heap allocations
+ * @param [in] w a window of a leg
+ * @param [in,out] c a search core, which is reset at the beginning
+ * @param [in] start_uvq, goal_uvq start and goal
+ * @return the number of searched states, -1 if goal is not reached, or -2 if a priority queue overflows
+ * @details a path is stored in c.path_id and c.path_action.
+ *          An action is recovered from headings of a state and its previous state.
+ */
+long search( const window& w, search_core& c, const uvq& start_uvq, const uvq& goal_uvq ) {
+    assert( w.size( ) <= c.capacity );
+    c.reset( );
+    auto [ start_u, start_v, start_q ] = start_uvq;
+    auto [ goal_u, goal_v, goal_q ] = goal_uvq;
+    const double u_min = w.u_range.first, v_min = w.v_range.first, q_min = w.q_range.first;
+    const double d_u = w.d_u, d_v = w.d_v, d_q = w.d_q;
+    const std::uint32_t s_id =
+        w.flat_id( u_id( start_u, u_min, d_u ), v_id( start_v, v_min, d_v ), q_id( start_q, q_min, d_q ) );
+    const std::uint32_t g_id =
+        w.flat_id( u_id( goal_u, u_min, d_u ), v_id( goal_v, v_min, d_v ), q_id( goal_q, q_min, d_q ) );
+
+    if( !c.push( 0, s_id ) ) {
+        return -2;
+    }
+    c.stamp[ s_id ] = c.generation;
+    c.g_cost[ s_id ] = 0;
+    bool is_goal_arrived = false;
+    long num_searched = 0;
+    while( c.heap_size > 0 ) {
+        auto [ t_curr, id_curr ] = c.pop( );
+        if( id_curr == g_id ) {
+            is_goal_arrived = true;
+            break;
+        }
+        //  An entry which should not to be searched
+        if( c.g_cost[ id_curr ] < t_curr ) {
+            continue;
+        }
+        auto [ u_id_curr, v_id_curr, q_id_curr ] = w.ids( id_curr );
+        double u_curr = u_val( u_id_curr, u_min, d_u ), v_curr = v_val( v_id_curr, v_min, d_v ),
+               q_curr = q_val( q_id_curr, q_min, d_q );
+
+        //  Take a rotation speed out of W
+        for( std::size_t a = 0; a < W.size( ); a++ ) {
+            //  Next state
+            double q_next = next_q( w, q_curr, a );
+            int q_id_next = q_id( q_next, q_min, d_q );
+            assert( 0 <= q_id_next && q_id_next < w.q_size );
+
+            double u_next = u_curr + V * dT * std::cos( ( q_next + q_curr ) / 2.0 );
+            double v_next = v_curr + V * dT * std::sin( ( q_next + q_curr ) / 2.0 );
+            int u_id_next = u_id( u_next, u_min, d_u ), v_id_next = v_id( v_next, v_min, d_v );
+            //  Out of workspace
+            if( !( 0 <= u_id_next && u_id_next < w.u_size && 0 <= v_id_next && v_id_next < w.v_size ) ) {
+                continue;
+            }
+
+            std::uint32_t id_next = w.flat_id( u_id_next, v_id_next, q_id_next );
+            if( !c.is_visited( id_next ) || t_curr + 1 < c.g_cost[ id_next ] ) {
+                c.stamp[ id_next ] = c.generation;
+                c.g_cost[ id_next ] = t_curr + 1;
+                c.prev[ id_next ] = id_curr;
+                if( !c.push( t_curr + 1, id_next ) ) {
+                    return -2;
+                }
+                num_searched++;
+            }
+        }
+    }
+    if( !is_goal_arrived ) {
+        return -1;
+    }
+
+    //  Retrieve a path into the path buffer
+    const std::size_t num_steps = c.g_cost[ g_id ];
+    assert( num_steps < c.path_capacity );
+    c.path_size = num_steps + 1;
+    std::uint32_t id = g_id;
+    for( std::size_t k = num_steps; k > 0; k-- ) {
+        c.path_id[ k ] = id;
+        id = c.prev[ id ];
+        //  An action which turns a previous heading into a heading
+        const int q_id_prev = std::get< 2 >( w.ids( id ) ), q_id_curr = std::get< 2 >( w.ids( c.path_id[ k ] ) );
+        std::size_t a = 0;
+        while( a < W.size( ) && q_id( next_q( w, q_val( q_id_prev, q_min, d_q ), a ), q_min, d_q ) != q_id_curr ) {
+            a++;
+        }
+        assert( a < W.size( ) );
+        c.path_action[ k - 1 ] = ( std::uint8_t ) a;
+    }
+    c.path_id[ 0 ] = id;
+    assert( id == s_id );
+
+    return num_searched;
+}
+
+/**
+ * @fn load_resolutions
+ * @brief load a resolution of each leg from a configuration of iwata-08
+ * @param [in] path a path of a configuration, whose line is "leg d_u d_v d_q" and "#" begins a comment
+ * @param [in] num_legs the number of legs
+ * @return resolutions of legs, default_resolution if a leg is not given
+ * @details
+ */
+std::vector< resolution > load_resolutions( const std::string& path, std::size_t num_legs ) {
+    std::vector< resolution > resolutions( num_legs, default_resolution );
+    std::ifstream ifs( path );
+    std::string line;
+    while( std::getline( ifs, line ) ) {
+        std::istringstream iss( line.substr( 0, line.find( '#' ) ) );
+        std::size_t leg;
+        double d_u, d_v, d_q;
+        if( iss >> leg >> d_u >> d_v >> d_q && 1 <= leg && leg <= num_legs && d_u > 0.0 && d_v > 0.0 && d_q > 0.0 ) {
+            resolutions.at( leg - 1 ) = { d_u, d_v, d_q };
+        }
+    }
+    return resolutions;
+}
+
+int main( int argc, char* argv[] ) {
+    //  Usage: a.out [configuration], which is tune.txt of iwata-08 by default
+    const std::string config_path = ( argc > 1 ? argv[ 1 ] : "tune.txt" );
+
     //  Constants
     std::cerr << offset_u << std::endl;
 
-    for( const auto& [ start_uvq, goal_uvq ] : starts_goals_uvq ) {
+    //  Windows of legs by resolutions of a configuration
+    const auto resolutions = load_resolutions( config_path, starts_goals_uvq.size( ) );
+    std::vector< window > windows;
+    for( std::size_t leg = 0; leg < starts_goals_uvq.size( ); leg++ ) {
+        const auto& [ start_uvq, goal_uvq ] = starts_goals_uvq.at( leg );
+        windows.emplace_back( start_uvq, goal_uvq, resolutions.at( leg ) );
+    }
+
+    //  A search core for the largest window, taken from a single buffer
+    //  A heap is as large as the largest estimate of a wavefront, not as tables
+    std::size_t num_states = 0, num_entries = 0;
+    for( const auto& w : windows ) {
+        num_states = std::max( num_states, w.size( ) );
+        num_entries = std::max( num_entries, w.frontier_size( ) );
+    }
+    const std::size_t num_steps = std::numeric_limits< std::uint16_t >::max( );
+    const std::size_t bytes = num_states * ( sizeof( std::uint32_t ) * 2 + sizeof( std::uint16_t ) ) +
+                              num_entries * sizeof( std::uint64_t ) +
+                              ( num_steps + 1 ) * ( sizeof( std::uint32_t ) + sizeof( std::uint8_t ) ) +
+                              6 * alignof( std::max_align_t );
+    std::vector< std::max_align_t > buffer( bytes / sizeof( std::max_align_t ) + 1 );
+    arena a( buffer.data( ), buffer.size( ) * sizeof( std::max_align_t ) );
+    search_core c( a, num_states, num_entries, num_steps );
+    std::cerr << "arena: " << a.bytes_used( ) << " [B], heap: " << num_entries << std::endl;
+
+    //  Actions of each leg are output to actions.txt as "ok <n> <actions> <error position> <error angle>" of iwata-07
+    std::ofstream ofs( "actions.txt" );
+    bool is_allocation_free = true, is_reached = true;
+    for( std::size_t leg = 0; leg < starts_goals_uvq.size( ); leg++ ) {
+        const auto& [ start_uvq, goal_uvq ] = starts_goals_uvq.at( leg );
+        const window& w = windows.at( leg );
         std::cerr << std::fixed << std::setprecision( 3 ) << start_uvq << " " << goal_uvq << std::endl;
+        std::cerr << w.u_range << " " << w.v_range << " " << w.q_range << " " << resolution( w.d_u, w.d_v, w.d_q )
+                  << std::endl;
 
-        auto [ start_u, start_v, start_q ] = start_uvq;
-        auto [ goal_u, goal_v, goal_q ] = goal_uvq;
-        double u_min = std::min( start_u, goal_u ) - offset_u, u_max = std::min( start_u, goal_u ) + offset_u;
-        //  Range of u-position [ u_min, u_max )
-        const std::pair< double, double > u_range = { u_min - d_u / 2.0, u_max + 3.0 * d_u / 2.0 };
-        std::cerr << u_range << " " << v_range << " " << q_range << std::endl;
+        //  A whole query, a search, its outputs and a re-simulation, has to take no heap allocations
+        std::size_t num_allocations_before = num_allocations;
+        long num_searched = search( w, c, start_uvq, goal_uvq );
+        if( num_searched < 0 ) {
+            ofs << ( num_searched == -2 ? "error queue overflow" : "error goal is not reached" ) << std::endl;
+        } else {
+            //  Outout a path as ( u, v, q, V ), a blank line separates legs
+            for( std::size_t k = 0; k < c.path_size; k++ ) {
+                auto [ u_id_curr, v_id_curr, q_id_curr ] = w.ids( c.path_id[ k ] );
+                double u = u_val( u_id_curr, w.u_range.first, w.d_u ), v = v_val( v_id_curr, w.v_range.first, w.d_v ),
+                       q = q_val( q_id_curr, w.q_range.first, w.d_q );
+                std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << q << " " << V << std::endl;
+            }
+            std::cout << std::endl;
+
+            //  Output actions as indices of W, "-" if there is none, and an error of an end pose,
+            //  which is re-simulated continuously out of the path buffer
+            const std::size_t num_actions = c.path_size - 1;
+            auto [ goal_u, goal_v, goal_q ] = goal_uvq;
+            auto [ u_end, v_end, q_end ] = resimulate( start_uvq, c.path_action, num_actions );
+            double q_err = std::remainder( q_end - goal_q, 2.0 * M_PI );
+            ofs << "ok " << num_actions << " ";
+            for( std::size_t k = 0; k < num_actions; k++ ) {
+                ofs << ( int ) c.path_action[ k ];
+            }
+            ofs << ( num_actions == 0 ? "- " : " " ) << std::fixed << std::setprecision( 4 )
+                << std::hypot( u_end - goal_u, v_end - goal_v ) << " " << std::fabs( q_err ) << std::endl;
+        }
+        std::size_t num_allocations_query = num_allocations - num_allocations_before;
+        is_allocation_free = is_allocation_free && ( num_allocations_query == 0 );
+        std::cerr << num_searched << " " << c.heap_peak << " " << num_allocations_query << std::endl;
+        is_reached = is_reached && ( num_searched >= 0 );
     }
+    std::cerr << std::boolalpha << "allocation free: " << is_allocation_free << std::endl;
 
-    return 0;
-}
\ No newline at end of file
+    return is_allocation_free && is_reached ? 0 : 1;
+}
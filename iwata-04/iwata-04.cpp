@@ -0,0 +1,437 @@
+/**
+ * @file iwata-04.cpp
+ * @brief Dijkstra's search with a symmetry-invariant query cache
+ * @date 2026-10-18
+ * @copyright MIT License
+ * @details Each leg ( start, goal ) is canonicalized under translation, u-mirroring and v-mirroring,
+ *          and a full search runs only when the canonical query is not in the cache yet.
+ *          A cached path is mapped back to the frame of the query.
+ *          Paths are output to stdout, and actions of each leg to actions.txt as
+ *          "ok <n> <actions> <error position> <error angle>" of iwata-07, or "error goal is not reached".
+ * */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <queue>
+#include <map>
+#include <numeric>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * @fn operator<< std::pair< S, T >
+ * @brief stream out of std::pair< S, T >
+ * @param [in] os an output stream
+ * @param [in] r a reference of std::pair< S, T >
+ * @return a reference of output stream
+ * @details
+ */
+template < class S, class T >
+std::ostream& operator<<( std::ostream& os, const std::pair< S, T >& r ) {
+    auto [ s, t ] = r;
+    os << "( " << s << ", " << t << " )";
+    return os;
+}
+
+/**
+ * @fn operator<< std::tuple< S, T, U >
+ * @brief stream out of std::tuple< S, T, U >
+ * @param [in] os a reference of output stream
+ * @param [in] r a const reference of std::tuple< S, T, U >
+ * @return reference of output stream
+ * @details
+ */
+template < class S, class T, class U >
+std::ostream& operator<<( std::ostream& os, const std::tuple< S, T, U >& r ) {
+    auto [ s, t, u ] = r;
+    os << "( " << s << ", " << t << ", " << u << " )";
+    return os;
+}
+
+/**
+ * @fn deg2rad
+ * @brief convert from degree to radian
+ * @param [in] deg an angle in degree
+ * @return rad
+ * @details
+ */
+double deg2rad( double deg ) { return M_PI * deg / 180.0; }
+
+//  Parameters of robot velocity
+//  Simulation parameters
+const double dT = 0.1;
+//  Robot translational velocity [m/s]
+//  V * dT = 0.01 [m/s]
+const double V = 0.1;
+
+//  Robot rotational velocity [rad/s]
+//  W * dT = { -3.0 [deg/s ], 0.0 [deg/s], 3.0 [deg/s] }
+const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
+
+/**
+ * @fn resimulate
+ * @brief simulate actions continuously from a start pose
+ * @param [in] start a start pose
+ * @param [in] actions indices of W
+ * @return poses after every action, the first of which is a start pose
+ * @details angles are a prefix sum of rotations, and positions are prefix sums of translations at mean angles,
+ *          so that steps do not depend on each other except for the prefix sums
+ */
+std::vector< std::tuple< double, double, double > > resimulate( const std::tuple< double, double, double >& start,
+                                                                const std::vector< int >& actions ) {
+    const std::size_t n = actions.size( );
+    auto [ u_start, v_start, q_start ] = start;
+    std::vector< double > q( n + 1, q_start ), u( n + 1, u_start ), v( n + 1, v_start );
+    std::transform( actions.begin( ), actions.end( ), q.begin( ) + 1, []( int a ) { return W.at( a ) * dT; } );
+    std::partial_sum( q.begin( ), q.end( ), q.begin( ) );
+    for( std::size_t k = 0; k < n; k++ ) {
+        u[ k + 1 ] = V * dT * std::cos( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+        v[ k + 1 ] = V * dT * std::sin( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+    }
+    std::partial_sum( u.begin( ), u.end( ), u.begin( ) );
+    std::partial_sum( v.begin( ), v.end( ), v.begin( ) );
+
+    std::vector< std::tuple< double, double, double > > poses( n + 1 );
+    for( std::size_t k = 0; k <= n; k++ ) {
+        poses[ k ] = { u[ k ], v[ k ], q[ k ] };
+    }
+    return poses;
+}
+
+//  Data Set
+//  Offset
+const double d_u = 0.005;
+const double offset_u = ( std::floor( V / deg2rad( 30.0 ) * 1000.0 ) + 1.0 ) / 1000.0;
+//  { Start, Goal }
+using uvq = std::tuple< double, double, double >;
+const std::vector< std::pair< uvq, uvq > > starts_goals_uvq = {
+    { { 1.863, 0.000, deg2rad( 270.0 ) }, { 2.484, -0.600, deg2rad( 0.0 ) } },
+    { { 2.484, -0.600, deg2rad( 0.0 ) }, { 3.726, 0.000, deg2rad( 30.0 ) } },
+    { { 3.726, 0.000, deg2rad( 30.0 ) }, { 4.968, 0.600, deg2rad( 0.0 ) } },
+    { { 4.968, 0.600, deg2rad( 0.0 ) }, { 5.589, 0.000, deg2rad( 270.0 ) } },
+    { { 5.589, 0.000, deg2rad( 270.0 ) }, { 4.968, -0.600, deg2rad( 180.0 ) } },
+    { { 4.968, -0.600, deg2rad( 180.0 ) }, { 3.726, 0.000, deg2rad( 150.0 ) } },
+    { { 3.726, 0.000, deg2rad( 150.0 ) }, { 2.484, 0.600, deg2rad( 180.0 ) } },
+    { { 2.484, 0.600, deg2rad( 180.0 ) }, { 1.863, 0.000, deg2rad( 270.0 ) } } };
+
+//  Range of v-position [ v_min, v_max ]
+const double d_v = 0.005;
+const std::pair< double, double > v_range = { -1.200, 1.200 };
+
+//  Range of angle [ 0, 2 pi ), an id of q is an angle of q_id * d_q
+const double d_q = M_PI / 60.0;
+const int q_size = ( int ) std::round( 2.0 * M_PI / d_q );
+
+//  Constants
+//  INF for time
+const double INF = 1e6;
+
+//  state = ( u_id, v_id, q_id ), u_id and v_id are relative to a start cell
+using state = std::tuple< int, int, int >;
+
+//  entry = ( t[s], state )
+using entry = std::pair< double, state >;
+
+//  symmetry = ( mirror of u, mirror of v )
+using symmetry = std::pair< bool, bool >;
+const std::vector< symmetry > symmetries = { { false, false }, { true, false }, { false, true }, { true, true } };
+
+/**
+ * @fn rel_id
+ * @brief convert a displacement from a start cell centre to a relative id
+ * @param [in] d a displacement in meter
+ * @param [in] d_c a cell size in meter
+ * @return id
+ * @details a start cell is an id of 0, whose centre is at a displacement of 0
+ */
+int rel_id( double d, double d_c ) { return ( int ) std::floor( d / d_c + 0.5 ); }
+
+/**
+ * @fn q_id
+ * @brief convert an angle to id
+ * @param [in] q an angle by radian
+ * @return id in [ 0, q_size )
+ * @details requires d_q and q_size
+ */
+int q_id( double q ) { return ( ( rel_id( q, d_q ) % q_size ) + q_size ) % q_size; }
+
+/**
+ * @fn q_val
+ * @brief convert q_id to an angle of q
+ * @param [in] q_id
+ * @return an angle of q [rad]
+ * @details requires d_q
+ */
+double q_val( int q_id ) { return ( double ) q_id * d_q; }
+
+/**
+ * @fn action_id
+ * @brief find an index of W which turns q_id_prev into q_id_curr
+ * @param [in] q_id_prev, q_id_curr ids of angles of a previous state and a state
+ * @return an index of W
+ * @details an action is recovered from a previous state, instead of being stored for each state
+ */
+int action_id( int q_id_prev, int q_id_curr ) {
+    for( std::size_t a = 0; a < W.size( ); a++ ) {
+        if( q_id( q_val( q_id_prev ) + W.at( a ) * dT ) == q_id_curr ) {
+            return ( int ) a;
+        }
+    }
+    assert( false );
+    return -1;
+}
+
+/**
+ * @fn transform
+ * @brief mirror a state
+ * @param [in] s a state relative to a start cell
+ * @param [in] sym a symmetry
+ * @return a mirrored state
+ * @details u-mirroring maps q to pi - q, v-mirroring maps q to -q. Each symmetry is its own inverse.
+ */
+state transform( const state& s, const symmetry& sym ) {
+    auto [ u, v, q ] = s;
+    auto [ mirror_u, mirror_v ] = sym;
+    if( mirror_u ) {
+        u = -u;
+        q = q_size / 2 - q;
+    }
+    if( mirror_v ) {
+        v = -v;
+        q = -q;
+    }
+    return state( u, v, ( ( q % q_size ) + q_size ) % q_size );
+}
+
+/**
+ * @fn transform_action
+ * @brief mirror an action
+ * @param [in] a an index of W
+ * @param [in] sym a symmetry
+ * @return a mirrored index of W
+ * @details a single mirroring swaps left and right turns, W has to be symmetric
+ */
+int transform_action( int a, const symmetry& sym ) {
+    auto [ mirror_u, mirror_v ] = sym;
+    return ( mirror_u != mirror_v ? ( int ) W.size( ) - 1 - a : a );
+}
+
+/**
+ * @struct query
+ * @brief a search query relative to a start cell
+ * @details the start is at ( 0, 0, q_start ), and the workspace is [ u_lo, u_hi ] x [ v_lo, v_hi ]
+ */
+struct query {
+    int q_start;
+    int u_goal, v_goal, q_goal;
+    int u_lo, u_hi, v_lo, v_hi;
+    auto key( ) const { return std::tie( q_start, u_goal, v_goal, q_goal, u_lo, u_hi, v_lo, v_hi ); }
+    query transformed( const symmetry& sym ) const {
+        auto [ mirror_u, mirror_v ] = sym;
+        query r = *this;
+        r.q_start = std::get< 2 >( transform( { 0, 0, q_start }, sym ) );
+        std::tie( r.u_goal, r.v_goal, r.q_goal ) = transform( { u_goal, v_goal, q_goal }, sym );
+        if( mirror_u ) {
+            r.u_lo = -u_hi;
+            r.u_hi = -u_lo;
+        }
+        if( mirror_v ) {
+            r.v_lo = -v_hi;
+            r.v_hi = -v_lo;
+        }
+        return r;
+    }
+};
+bool operator<( const query& a, const query& b ) { return a.key( ) < b.key( ); }
+
+/**
+ * @fn canonicalize
+ * @brief find a canonical query and a symmetry which maps a given query to it
+ * @param [in] r a query
+ * @return ( canonical query, symmetry )
+ * @details the canonical query is the least one among all the mirrored queries
+ */
+std::pair< query, symmetry > canonicalize( const query& r ) {
+    std::pair< query, symmetry > best = { r, symmetries.front( ) };
+    for( const auto& sym : symmetries ) {
+        query t = r.transformed( sym );
+        if( t < best.first ) {
+            best = { t, sym };
+        }
+    }
+    return best;
+}
+
+/**
+ * @fn search
+ * @brief Dijkstra's search of a query
+ * @param [in] r a query
+ * @param [out] num_searched the number of states pushed to a priority queue
+ * @return a path of states from start to goal and actions as indices of W, or empty ones if goal is not reached
+ * @details
+ */
+std::pair< std::vector< state >, std::vector< int > > search( const query& r, int& num_searched ) {
+    const int u_size = r.u_hi - r.u_lo + 1, v_size = r.v_hi - r.v_lo + 1;
+
+    //  Cost table
+    std::vector< std::vector< std::vector< double > > > g_cost(
+        u_size, std::vector< std::vector< double > >( v_size, std::vector< double >( q_size, INF ) ) );
+    //  Previous state table
+    std::vector< std::vector< std::vector< state > > > prev(
+        u_size, std::vector< std::vector< state > >( v_size, std::vector< state >( q_size, { -1, -1, -1 } ) ) );
+
+    //  entry = ( t[s], ( u_id, v_id, q_id ) ), tables are indexed by ( u_id - u_lo, v_id - v_lo, q_id )
+    std::priority_queue< entry, std::vector< entry >, std::greater< entry > > pri_que;
+    pri_que.push( { 0.0, { 0, 0, r.q_start } } );
+    g_cost.at( -r.u_lo ).at( -r.v_lo ).at( r.q_start ) = 0.0;
+
+    bool is_goal_arrived = false;
+    num_searched = 0;
+    while( !pri_que.empty( ) ) {
+        auto [ t_curr, s_curr ] = pri_que.top( );
+        auto [ u_id_curr, v_id_curr, q_id_curr ] = s_curr;
+        double u_curr = u_id_curr * d_u, v_curr = v_id_curr * d_v, q_curr = q_val( q_id_curr );
+        pri_que.pop( );
+
+        // Check if it arrives at goal
+        if( u_id_curr == r.u_goal && v_id_curr == r.v_goal && q_id_curr == r.q_goal ) {
+            is_goal_arrived = true;
+            break;
+        }
+        //  An entry which should not to be searched
+        if( g_cost.at( u_id_curr - r.u_lo ).at( v_id_curr - r.v_lo ).at( q_id_curr ) < t_curr ) {
+            continue;
+        }
+
+        //  Take a rotation speed w out of W
+        for( std::size_t a = 0; a < W.size( ); a++ ) {
+            //  Next state
+            double q_next = q_curr + W.at( a ) * dT;
+            int q_id_next = q_id( q_next );
+            assert( 0 <= q_id_next && q_id_next < q_size );
+
+            double u_next = u_curr + V * dT * std::cos( ( q_next + q_curr ) / 2.0 );
+            double v_next = v_curr + V * dT * std::sin( ( q_next + q_curr ) / 2.0 );
+            int u_id_next = rel_id( u_next, d_u ), v_id_next = rel_id( v_next, d_v );
+            //  Out of workspace
+            if( !( r.u_lo <= u_id_next && u_id_next <= r.u_hi && r.v_lo <= v_id_next && v_id_next <= r.v_hi ) ) {
+                continue;
+            }
+
+            if( t_curr + 1.0 < g_cost.at( u_id_next - r.u_lo ).at( v_id_next - r.v_lo ).at( q_id_next ) ) {
+                pri_que.push( { t_curr + 1.0, { u_id_next, v_id_next, q_id_next } } );
+                g_cost.at( u_id_next - r.u_lo ).at( v_id_next - r.v_lo ).at( q_id_next ) = t_curr + 1.0;
+                prev.at( u_id_next - r.u_lo ).at( v_id_next - r.v_lo ).at( q_id_next ) = s_curr;
+                num_searched++;
+            }
+        }
+    }
+
+    //  Retrieve a path
+    std::vector< state > path_state;
+    std::vector< int > path_action;
+    if( !is_goal_arrived ) {
+        return { path_state, path_action };
+    }
+    state s_curr( r.u_goal, r.v_goal, r.q_goal );
+    while( s_curr != state( 0, 0, r.q_start ) ) {
+        path_state.push_back( s_curr );
+        auto [ u, v, q ] = s_curr;
+        s_curr = prev.at( u - r.u_lo ).at( v - r.v_lo ).at( q );
+        path_action.push_back( action_id( std::get< 2 >( s_curr ), q ) );
+    }
+    path_state.push_back( s_curr );
+    std::reverse( path_state.begin( ), path_state.end( ) );
+    std::reverse( path_action.begin( ), path_action.end( ) );
+
+    return { path_state, path_action };
+}
+
+int main( ) {
+    assert( q_size % 2 == 0 );
+
+    //  Cache of paths and actions, indexed by a canonical query
+    std::map< query, std::pair< std::vector< state >, std::vector< int > > > cache;
+    int num_hit = 0, num_miss = 0;
+    double hit_msec = 0.0, miss_msec = 0.0;
+    std::ofstream ofs( "actions.txt" );
+
+    for( const auto& [ start_uvq, goal_uvq ] : starts_goals_uvq ) {
+        auto time_begin = std::chrono::steady_clock::now( );
+        auto [ start_u, start_v, start_q ] = start_uvq;
+        auto [ goal_u, goal_v, goal_q ] = goal_uvq;
+
+        //  Query relative to a start cell
+        query r;
+        r.q_start = q_id( start_q );
+        r.u_goal = rel_id( goal_u - start_u, d_u );
+        r.v_goal = rel_id( goal_v - start_v, d_v );
+        r.q_goal = q_id( goal_q );
+        r.u_lo = rel_id( std::min( start_u, goal_u ) - offset_u - start_u, d_u );
+        r.u_hi = rel_id( std::max( start_u, goal_u ) + offset_u - start_u, d_u );
+        r.v_lo = rel_id( v_range.first - start_v, d_v );
+        r.v_hi = rel_id( v_range.second - start_v, d_v );
+
+        //  Look up the cache by a canonical query, and search it on a miss
+        auto [ r_canon, sym ] = canonicalize( r );
+        auto it = cache.find( r_canon );
+        bool is_hit = ( it != cache.end( ) );
+        if( !is_hit ) {
+            int num_searched = 0;
+            it = cache.emplace( r_canon, search( r_canon, num_searched ) ).first;
+            std::cerr << "searched: " << num_searched << std::endl;
+        }
+
+        //  Map a canonical path back to the frame of the query
+        std::vector< uvq > path_uvq;
+        for( const auto& s : it->second.first ) {
+            auto [ u, v, q ] = transform( s, sym );
+            path_uvq.push_back( { start_u + u * d_u, start_v + v * d_v, q_val( q ) } );
+        }
+        std::vector< int > path_action;
+        for( auto a : it->second.second ) {
+            path_action.push_back( transform_action( a, sym ) );
+        }
+
+        double msec =
+            std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now( ) - time_begin ).count( );
+        ( is_hit ? num_hit : num_miss )++;
+        ( is_hit ? hit_msec : miss_msec ) += msec;
+        std::cerr << std::fixed << std::setprecision( 3 ) << start_uvq << " " << goal_uvq << " "
+                  << ( is_hit ? "hit" : "miss" ) << " " << msec << " [ms]" << std::endl;
+        if( path_uvq.empty( ) ) {
+            std::cerr << "goal is not reached" << std::endl;
+            ofs << "error goal is not reached" << std::endl;
+        } else {
+            //  Actions as indices of W, "-" if there is none, and an error of an end pose by a continuous simulation
+            auto [ u_end, v_end, q_end ] = resimulate( start_uvq, path_action ).back( );
+            std::cerr << "end: " << uvq( u_end, v_end, q_end ) << std::endl;
+            ofs << "ok " << path_action.size( ) << " ";
+            for( auto a : path_action ) {
+                ofs << a;
+            }
+            ofs << ( path_action.empty( ) ? "- " : " " ) << std::fixed << std::setprecision( 4 )
+                << std::hypot( u_end - goal_u, v_end - goal_v ) << " "
+                << std::fabs( std::remainder( q_end - goal_q, 2.0 * M_PI ) ) << std::endl;
+        }
+
+        //  Outout a path as ( u, v, q, V ), a blank line separates legs
+        for( const auto& [ u, v, q ] : path_uvq ) {
+            std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << q << " " << V << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    //  Cache statistics
+    std::cerr << std::fixed << std::setprecision( 3 ) << "hit: " << num_hit << ", miss: " << num_miss
+              << ", hit rate: " << ( double ) num_hit / ( num_hit + num_miss ) << std::endl;
+    std::cerr << "latency of hit: " << ( num_hit > 0 ? hit_msec / num_hit : 0.0 ) << " [ms], "
+              << "latency of miss: " << ( num_miss > 0 ? miss_msec / num_miss : 0.0 ) << " [ms]" << std::endl;
+
+    return 0;
+}
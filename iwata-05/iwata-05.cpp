@@ -0,0 +1,480 @@
+/**
+ * @file iwata-05.cpp
+ * @brief Parallel delta-stepping search
+ * @date 2026-10-18
+ * @copyright MIT License
+ * @details Buckets of width delta are relaxed by worker threads with atomic min-updates on a flat label array.
+ *          A label packs ( cost, previous id ), so that ties are broken by the lowest previous id
+ *          and a path is the same for any number of threads.
+ *          The result is checked against the sequential Dijkstra's search of iwata-03.
+ * */
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <queue>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * @fn deg2rad
+ * @brief convert from degree to radian
+ * @param [in] deg an angle in degree
+ * @return rad
+ * @details
+ */
+double deg2rad( double deg ) { return M_PI * deg / 180.0; }
+
+//  Constants
+//  INF for time
+const double INF = 1e6;
+
+//  Data Set 8 of iwata-03
+//  Range of u-position [ u_min, u_max )
+const double d_u = 0.005, u_min = 1.800 - d_u / 2.0, u_max = 2.400 + d_u / 2.0;
+//  Range of v-position [ v_min, v_max )
+const double d_v = 0.005, v_min = -1.200 - d_v / 2.0, v_max = 1.200 + d_v / 2.0;
+//  Range of angle [ q_min, q_max )
+const double d_q = M_PI / 60.0, q_min = 0.0 - d_q / 2.0, q_max = 2.0 * M_PI - d_q / 2.0;
+//  Start position and angle
+const double u_start = 2.400, v_start = 0.600, q_start = deg2rad( 180.0 );
+//  Goal position and angle
+const double u_goal = 1.800, v_goal = 0.000, q_goal = deg2rad( 270.0 );
+
+//  Parameters of robot velocity
+//  Robot translational velocity [m/s]
+const double V = 0.1;
+//  Robot rotational velocity [rad/s]
+const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
+//  Simulation parameters
+const double dT = 0.1;
+
+//  Parameters of delta-stepping
+//  Cost of an action in steps, every action is a light edge if it is not greater than delta
+const std::uint32_t step_cost = 1;
+//  Bucket width in steps
+const std::uint32_t delta = 1;
+
+/**
+ * @fn u_id
+ * @brief convert a position of u to an id of u
+ * @param [in] u a position in meter
+ * @return id
+ * @details requires u_min and d_u
+ */
+int u_id( double u ) { return ( int ) std::floor( ( u - u_min ) / d_u ); }
+
+/**
+ * @fn u_val
+ * @brief convert u_id to a position of u
+ * @param [in] u_id
+ * @return position of u [m]
+ * @details requires u_min and d_u
+ */
+double u_val( int u_id ) { return ( double ) u_id * d_u + u_min + d_u / 2.0; }
+
+/**
+ * @fn v_id
+ * @brief convert v position to id
+ * @param [in] v a position in meter
+ * @return id
+ * @details requires v_min and d_v
+ */
+int v_id( double v ) { return ( int ) std::floor( ( v - v_min ) / d_v ); }
+
+/**
+ * @fn v_val
+ * @brief convert v_id to a position of v
+ * @param [in] v_id
+ * @return position of v [m]
+ * @details requires v_min and d_v
+ */
+double v_val( int v_id ) { return ( double ) v_id * d_v + ( v_min + d_v / 2.0 ); }
+
+/**
+ * @fn q_id
+ * @brief convert an angle to id
+ * @param [in] q an angle by radian
+ * @return id
+ * @details requires q_min and d_q, and M_PI in cmath
+ */
+int q_id( double q ) { return ( int ) std::floor( ( q - q_min ) / d_q ); }
+
+/**
+ * @fn q_val
+ * @brief convert q_id to an angle of q
+ * @param [in] q_id
+ * @return an angle of q [rad]
+ * @details requires q_min and d_q
+ */
+double q_val( int q_id ) { return ( double ) q_id * d_q + ( q_min + d_q / 2.0 ); }
+
+//  Size of the configuration space
+const int u_size = u_id( u_max ) + 1, v_size = v_id( v_max ) + 1, q_size = q_id( q_max );
+
+/**
+ * @fn flat_id
+ * @brief convert ( u_id, v_id, q_id ) to an id of a flat array
+ * @param [in] u_id, v_id, q_id
+ * @return id
+ * @details
+ */
+std::uint32_t flat_id( int u_id, int v_id, int q_id ) { return ( u_id * v_size + v_id ) * q_size + q_id; }
+
+/**
+ * @fn next_id
+ * @brief take an action w from a state
+ * @param [in] id a flat id of a current state
+ * @param [in] w a rotation speed
+ * @return a flat id of a next state, or -1 if it is out of workspace
+ * @details the same transition as iwata-03
+ */
+std::int64_t next_id( std::uint32_t id, double w ) {
+    int q_id_curr = id % q_size, v_id_curr = ( id / q_size ) % v_size, u_id_curr = id / q_size / v_size;
+    double u_curr = u_val( u_id_curr ), v_curr = v_val( v_id_curr ), q_curr = q_val( q_id_curr );
+
+    double q_next = q_curr + w * dT;
+    if( q_next < q_min ) {
+        q_next += 2.0 * M_PI;
+    } else if( q_max <= q_next ) {
+        q_next -= 2.0 * M_PI;
+    }
+    int q_id_next = q_id( q_next );
+    assert( 0 <= q_id_next && q_id_next < q_size );
+
+    double u_next = u_curr + V * dT * std::cos( ( q_next + q_curr ) / 2.0 );
+    double v_next = v_curr + V * dT * std::sin( ( q_next + q_curr ) / 2.0 );
+    int u_id_next = u_id( u_next ), v_id_next = v_id( v_next );
+    //  Out of workspace
+    if( !( 0 <= u_id_next && u_id_next < u_size && 0 <= v_id_next && v_id_next < v_size ) ) {
+        return -1;
+    }
+    return flat_id( u_id_next, v_id_next, q_id_next );
+}
+
+//  label = ( cost << 32 ) | previous id, the least label is the best
+using label = std::uint64_t;
+const label NO_LABEL = ~label( 0 );
+label make_label( std::uint32_t cost, std::uint32_t prev_id ) { return ( label( cost ) << 32 ) | prev_id; }
+std::uint32_t label_cost( label l ) { return ( std::uint32_t )( l >> 32 ); }
+std::uint32_t label_prev( label l ) { return ( std::uint32_t )( l & 0xffffffffu ); }
+
+/**
+ * @fn atomic_min
+ * @brief update an atomic label to a given one if it is less
+ * @param [in] a an atomic label
+ * @param [in] l a label
+ * @return a label before the update, which is not greater than l if it is not updated
+ * @details
+ */
+label atomic_min( std::atomic< label >& a, label l ) {
+    label curr = a.load( std::memory_order_relaxed );
+    while( l < curr ) {
+        if( a.compare_exchange_weak( curr, l, std::memory_order_relaxed ) ) {
+            return curr;
+        }
+    }
+    return curr;
+}
+
+/**
+ * @class worker_pool
+ * @brief persistent worker threads which run a task together and wait at a barrier
+ * @details a calling thread works as thread 0, and the other threads are spawned once
+ */
+class worker_pool {
+  public:
+    explicit worker_pool( int num_threads ) : num_threads( num_threads ) {
+        for( int t = 1; t < num_threads; t++ ) {
+            threads.emplace_back( [ this, t ] { work( t ); } );
+        }
+    }
+    ~worker_pool( ) {
+        {
+            std::lock_guard< std::mutex > lock( mtx );
+            is_quit = true;
+        }
+        cv_start.notify_all( );
+        for( auto& th : threads ) {
+            th.join( );
+        }
+    }
+    int size( ) const { return num_threads; }
+    /**
+     * @fn run
+     * @brief call f( t ) by every thread t in [ 0, size( ) ), and wait for all of them
+     * @param [in] f a task
+     * @details
+     */
+    void run( const std::function< void( int ) >& f ) {
+        {
+            std::lock_guard< std::mutex > lock( mtx );
+            task = &f;
+            num_running = num_threads - 1;
+            epoch++;
+        }
+        cv_start.notify_all( );
+        f( 0 );
+        std::unique_lock< std::mutex > lock( mtx );
+        cv_done.wait( lock, [ this ] { return num_running == 0; } );
+    }
+
+  private:
+    void work( int t ) {
+        std::size_t epoch_done = 0;
+        while( true ) {
+            const std::function< void( int ) >* f;
+            {
+                std::unique_lock< std::mutex > lock( mtx );
+                cv_start.wait( lock, [ & ] { return is_quit || epoch != epoch_done; } );
+                if( is_quit ) {
+                    return;
+                }
+                epoch_done = epoch;
+                f = task;
+            }
+            ( *f )( t );
+            std::lock_guard< std::mutex > lock( mtx );
+            if( --num_running == 0 ) {
+                cv_done.notify_one( );
+            }
+        }
+    }
+    const int num_threads;
+    std::vector< std::thread > threads;
+    std::mutex mtx;
+    std::condition_variable cv_start, cv_done;
+    const std::function< void( int ) >* task = nullptr;
+    std::size_t epoch = 0;
+    int num_running = 0;
+    bool is_quit = false;
+};
+
+/**
+ * @fn parallel_for
+ * @brief split [ 0, n ) into ranges of threads and call f( thread, begin, end ) for each of them in parallel
+ * @param [in] pool worker threads
+ * @param [in] n the size of a range
+ * @param [in] f a function
+ * @details
+ */
+template < class F >
+void parallel_for( worker_pool& pool, std::size_t n, F f ) {
+    const std::size_t chunk = ( n + pool.size( ) - 1 ) / pool.size( );
+    pool.run( [ & ]( int t ) { f( t, std::min( n, t * chunk ), std::min( n, ( t + 1 ) * chunk ) ); } );
+}
+
+/**
+ * @fn delta_stepping
+ * @brief parallel delta-stepping search
+ * @param [in] s_id, g_id flat ids of start and goal
+ * @param [in] pool worker threads
+ * @param [out] labels a label of each state
+ * @return true if goal is arrived
+ * @details a search stops after the bucket of goal, so that labels of costs not greater than goal are final.
+ *          Each thread inserts states into its own buckets, and a bucket of all the threads is merged in parallel.
+ */
+bool delta_stepping( std::uint32_t s_id, std::uint32_t g_id, worker_pool& pool, std::vector< std::atomic< label > >& labels ) {
+    const int num_threads = pool.size( );
+    //  buckets.at( t ).at( i ): states in a bucket i inserted by a thread t
+    std::vector< std::vector< std::vector< std::uint32_t > > > buckets( num_threads );
+    buckets.at( 0 ).push_back( { s_id } );
+    labels.at( s_id ).store( make_label( 0, s_id ) );
+
+    //  A bucket of all the threads, and offsets of threads in it
+    std::vector< std::uint32_t > frontier;
+    std::vector< std::size_t > offsets( num_threads + 1, 0 );
+    auto num_buckets = [ & ]( ) {
+        std::size_t m = 0;
+        for( const auto& b : buckets ) {
+            m = std::max( m, b.size( ) );
+        }
+        return m;
+    };
+    for( std::size_t i = 0; i < num_buckets( ); i++ ) {
+        //  Goal is final if it is in an earlier bucket
+        if( labels.at( g_id ).load( ) != NO_LABEL && label_cost( labels.at( g_id ).load( ) ) / delta < i ) {
+            return true;
+        }
+        //  Relax light edges until the bucket is empty, states may be reinserted into the same bucket
+        while( true ) {
+            for( int t = 0; t < num_threads; t++ ) {
+                offsets.at( t + 1 ) = offsets.at( t ) + ( i < buckets.at( t ).size( ) ? buckets.at( t ).at( i ).size( ) : 0 );
+            }
+            if( offsets.back( ) == 0 ) {
+                break;
+            }
+            frontier.resize( offsets.back( ) );
+            pool.run( [ & ]( int t ) {
+                if( i < buckets[ t ].size( ) ) {
+                    std::copy( buckets[ t ][ i ].begin( ), buckets[ t ][ i ].end( ), frontier.begin( ) + offsets[ t ] );
+                    buckets[ t ][ i ].clear( );
+                }
+            } );
+            parallel_for( pool, frontier.size( ), [ & ]( int t, std::size_t begin, std::size_t end ) {
+                auto& own = buckets[ t ];
+                for( std::size_t k = begin; k < end; k++ ) {
+                    std::uint32_t id = frontier[ k ];
+                    std::uint32_t cost = label_cost( labels[ id ].load( std::memory_order_relaxed ) );
+                    //  A stale entry which has moved to another bucket
+                    if( cost / delta != i ) {
+                        continue;
+                    }
+                    for( auto w : W ) {
+                        std::int64_t n_id = next_id( id, w );
+                        if( n_id < 0 ) {
+                            continue;
+                        }
+                        //  A state is inserted only if its cost decreases, not if only its previous id decreases
+                        label l_prev = atomic_min( labels[ n_id ], make_label( cost + step_cost, id ) );
+                        if( l_prev == NO_LABEL || cost + step_cost < label_cost( l_prev ) ) {
+                            std::size_t b = ( cost + step_cost ) / delta;
+                            if( own.size( ) <= b ) {
+                                own.resize( b + 1 );
+                            }
+                            own[ b ].push_back( ( std::uint32_t ) n_id );
+                        }
+                    }
+                }
+            } );
+        }
+    }
+    return labels.at( g_id ).load( ) != NO_LABEL;
+}
+
+/**
+ * @fn dijkstra
+ * @brief sequential Dijkstra's search on a flat cost array
+ * @param [in] s_id, g_id flat ids of start and goal
+ * @param [out] g_cost a cost of each state
+ * @return true if goal is arrived
+ * @details the same search as iwata-03
+ */
+bool dijkstra( std::uint32_t s_id, std::uint32_t g_id, std::vector< double >& g_cost ) {
+    //  entry = ( t[s], id )
+    using entry = std::pair< double, std::uint32_t >;
+    std::priority_queue< entry, std::vector< entry >, std::greater< entry > > pri_que;
+    pri_que.push( { 0.0, s_id } );
+    g_cost.at( s_id ) = 0.0;
+
+    while( !pri_que.empty( ) ) {
+        auto [ t_curr, id ] = pri_que.top( );
+        pri_que.pop( );
+        if( id == g_id ) {
+            return true;
+        }
+        if( g_cost.at( id ) < t_curr ) {
+            continue;
+        }
+        for( auto w : W ) {
+            std::int64_t n_id = next_id( id, w );
+            if( n_id >= 0 && t_curr + 1.0 < g_cost.at( n_id ) ) {
+                pri_que.push( { t_curr + 1.0, ( std::uint32_t ) n_id } );
+                g_cost.at( n_id ) = t_curr + 1.0;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @fn retrieve_path
+ * @brief retrieve a path from labels
+ * @param [in] s_id, g_id flat ids of start and goal
+ * @param [in] labels a label of each state
+ * @return flat ids from start to goal
+ * @details
+ */
+std::vector< std::uint32_t > retrieve_path( std::uint32_t s_id, std::uint32_t g_id,
+                                            const std::vector< std::atomic< label > >& labels ) {
+    std::vector< std::uint32_t > path_id;
+    for( std::uint32_t id = g_id; id != s_id; id = label_prev( labels.at( id ).load( ) ) ) {
+        path_id.push_back( id );
+    }
+    path_id.push_back( s_id );
+    std::reverse( path_id.begin( ), path_id.end( ) );
+    return path_id;
+}
+
+int main( int argc, char* argv[] ) {
+    //  Usage: a.out [ threads ]
+    const int num_threads =
+        ( argc > 1 ? std::max( 1, std::stoi( argv[ 1 ] ) ) : ( int ) std::max( 1u, std::thread::hardware_concurrency( ) ) );
+
+    //  Constants
+    const std::size_t n = ( std::size_t ) u_size * v_size * q_size;
+    std::cerr << u_size << " " << v_size << " " << q_size << " " << num_threads << std::endl;
+    const std::uint32_t s_id = flat_id( u_id( u_start ), v_id( v_start ), q_id( q_start ) );
+    const std::uint32_t g_id = flat_id( u_id( u_goal ), v_id( v_goal ), q_id( q_goal ) );
+
+    //  Sequential Dijkstra's search
+    auto time_begin = std::chrono::steady_clock::now( );
+    std::vector< double > g_cost( n, INF );
+    bool is_goal_arrived_dijkstra = dijkstra( s_id, g_id, g_cost );
+    double msec_dijkstra =
+        std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now( ) - time_begin ).count( );
+
+    //  Parallel delta-stepping search, worker threads are spawned once before a search
+    std::vector< std::atomic< label > > labels( n );
+    worker_pool pool( num_threads );
+    auto clear_labels = [ & ]( int, std::size_t begin, std::size_t end ) {
+        for( std::size_t k = begin; k < end; k++ ) {
+            labels[ k ].store( NO_LABEL, std::memory_order_relaxed );
+        }
+    };
+    time_begin = std::chrono::steady_clock::now( );
+    parallel_for( pool, n, clear_labels );
+    bool is_goal_arrived = delta_stepping( s_id, g_id, pool, labels );
+    double msec_delta =
+        std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now( ) - time_begin ).count( );
+
+    std::cerr << std::boolalpha << is_goal_arrived_dijkstra << " " << is_goal_arrived << std::endl;
+    std::cerr << std::fixed << std::setprecision( 3 ) << "dijkstra: " << msec_dijkstra << " [ms], "
+              << "delta-stepping: " << msec_delta << " [ms]" << std::endl;
+    if( !is_goal_arrived ) {
+        return 1;
+    }
+
+    //  Costs less than goal are final in both of the searches, and they have to match
+    const double g_goal = label_cost( labels.at( g_id ).load( ) );
+    std::size_t num_mismatched = ( g_cost.at( g_id ) == g_goal ? 0 : 1 );
+    for( std::size_t k = 0; k < n; k++ ) {
+        label l = labels[ k ].load( std::memory_order_relaxed );
+        double c = ( l == NO_LABEL ? INF : label_cost( l ) );
+        if( ( g_cost[ k ] < g_goal || c < g_goal ) && g_cost[ k ] != c ) {
+            num_mismatched++;
+        }
+    }
+    std::cerr << "cost: " << g_goal << ", mismatched: " << num_mismatched << std::endl;
+
+    //  Retrieve a path
+    const std::vector< std::uint32_t > path_id = retrieve_path( s_id, g_id, labels );
+
+    //  A path has to be the same as a path of a single thread
+    bool is_same_path = true;
+    if( num_threads > 1 ) {
+        worker_pool single( 1 );
+        parallel_for( single, n, clear_labels );
+        delta_stepping( s_id, g_id, single, labels );
+        is_same_path = ( retrieve_path( s_id, g_id, labels ) == path_id );
+        std::cerr << "same path as 1 thread: " << is_same_path << std::endl;
+    }
+
+    //  Outout a path as ( u, v, q, V )
+    for( auto id : path_id ) {
+        double u = u_val( id / q_size / v_size ), v = v_val( ( id / q_size ) % v_size ), q = q_val( id % q_size );
+        std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << q << " " << V << std::endl;
+    }
+
+    return num_mismatched == 0 && is_same_path ? 0 : 1;
+}
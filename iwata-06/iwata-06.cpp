@@ -0,0 +1,294 @@
+/**
+ * @file iwata-06.cpp
+ * @brief Bit-parallel BFS (breadth first search) over bitplanes of headings
+ * @date 2026-10-18
+ * @copyright MIT License
+ * @details An action maps a heading plane q to q' with a fixed shift ( du, dv ) of cells,
+ *          so that a level of BFS is shifted bitwise ORs of ( u, v ) bitplanes.
+ *          Only 1 bit is stored per state, and a level of a state is recovered along a path
+ *          by searching again from checkpoints of visited sets.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+//  [ Umin, Umax ), [ Vmin, Vmax ), [ Qmin, Qmax )
+//  Parameters of workspace and cell size
+
+//  Unprecise and fast
+const double Umin = -3.735, Umax = 0.005, dU = 0.010;
+const double Vmin = -1.205, Vmax = 0.005, dV = 0.010;
+const double Qmin = -181.5, Qmax = 178.5, dQ = 3.0;
+//  Precise and slow
+// const double Umin = -3.731, Umax = 0.001, dU = 0.002;
+// const double Vmin = -1.201, Vmax = 0.001, dV = 0.002;
+// const double Qmin = -180.75, Qmax = 179.25, dQ = 1.5;
+
+//  Parameters of robot velocity
+const double V = 0.1;
+const std::vector< double > W = { -30.0, 0.0, 30.0 };
+//  Simulation parameters
+const double dT = 0.1;
+
+//  Levels between checkpoints of visited sets
+const int K = 16;
+
+struct state {
+    int u;
+    int v;
+    int q;
+    state( ) : u( 0 ), v( 0 ), q( 0 ) {}
+    state( int _u, int _v, int _q ) : u( _u ), v( _v ), q( _q ) {}
+    state( double u_val, double v_val, double q_val )
+        : u( ( int ) std::floor( ( u_val - Umin ) / dU ) ),
+          v( ( int ) std::floor( ( v_val - Vmin ) / dV ) ),
+          q( ( int ) std::floor( ( q_val - Qmin ) / dQ ) ){ };
+    std::tuple< double, double, double > value( ) const {
+        double u_val = ( double ) u * dU + Umin + dU / 2.0;
+        double v_val = ( double ) v * dV + Vmin + dV / 2.0;
+        double q_val = ( double ) q * dQ + Qmin + dQ / 2.0;
+        return std::tuple< double, double, double >( u_val, v_val, q_val );
+    }
+};
+
+double deg2rad( double deg ) { return deg / 180.0 * M_PI; }
+
+//  Size of configuration space
+const state q000( Umin, Vmin, Qmin ), qNNN( Umax, Vmax, Qmax );
+const int u_num = qNNN.u + 1, v_num = qNNN.v + 1, q_num = qNNN.q;
+//  64-bit words of a row of u
+const int row_words = ( u_num + 63 ) / 64;
+
+/**
+ * @struct shift
+ * @brief an action from a heading plane q to q' with a shift ( du, dv )
+ * @details
+ */
+struct shift {
+    int q;
+    int q_next;
+    int du;
+    int dv;
+};
+
+/**
+ * @fn make_shifts
+ * @brief make shifts of all the headings and actions
+ * @return shifts
+ * @details a cell centre moves to ( u + du, v + dv ), where du and dv do not depend on ( u, v )
+ */
+std::vector< shift > make_shifts( ) {
+    std::vector< shift > shifts;
+    for( int q = 0; q < q_num; q++ ) {
+        auto [ u_curr_val, v_curr_val, q_curr_val ] = state( 0, 0, q ).value( );
+        for( auto w : W ) {
+            //  Orientation at the next state, a mean orientation is taken before normalization
+            double q_next_val = q_curr_val + dT * w;
+            double q_mean_val = ( q_curr_val + q_next_val ) / 2.0;
+            if( q_next_val < Qmin ) {
+                q_next_val += 360.0;
+            } else if( q_next_val >= Qmax ) {
+                q_next_val -= 360.0;
+            }
+            int du = ( int ) std::floor( 0.5 + dT * V * std::cos( deg2rad( q_mean_val ) ) / dU );
+            int dv = ( int ) std::floor( 0.5 + dT * V * std::sin( deg2rad( q_mean_val ) ) / dV );
+            shifts.push_back( { q, state( 0.0, 0.0, q_next_val ).q, du, dv } );
+        }
+    }
+    return shifts;
+}
+
+/**
+ * @struct bitplanes
+ * @brief a set of states as a bitplane of ( u, v ) per heading q
+ * @details a row of u is packed into 64-bit words, and rows are indexed by ( q, v )
+ */
+struct bitplanes {
+    std::vector< std::uint64_t > words;
+    bitplanes( ) : words( ( std::size_t ) q_num * v_num * row_words, 0 ) {}
+    std::uint64_t* row( int q, int v ) { return &words[ ( ( std::size_t ) q * v_num + v ) * row_words ]; }
+    const std::uint64_t* row( int q, int v ) const { return &words[ ( ( std::size_t ) q * v_num + v ) * row_words ]; }
+    bool test( const state& s ) const { return ( row( s.q, s.v )[ s.u / 64 ] >> ( s.u % 64 ) ) & 1; }
+    void set( const state& s ) { row( s.q, s.v )[ s.u / 64 ] |= std::uint64_t( 1 ) << ( s.u % 64 ); }
+    bool any( ) const {
+        return std::any_of( words.begin( ), words.end( ), []( std::uint64_t w ) { return w != 0; } );
+    }
+    std::size_t count( ) const {
+        std::size_t n = 0;
+        for( auto w : words ) {
+            n += __builtin_popcountll( w );
+        }
+        return n;
+    }
+};
+
+/**
+ * @fn shift_or
+ * @brief OR a row shifted by du bits into another row
+ * @param [in,out] dst a destination row
+ * @param [in] src a source row
+ * @param [in] du a shift of u, positive to larger u
+ * @details bits shifted out of a row are dropped, bits beyond u_num are cleared by a caller
+ */
+void shift_or( std::uint64_t* dst, const std::uint64_t* src, int du ) {
+    const int n = row_words;
+    //  Word and bit parts of a shift, du = 64 * ws + bs and 0 <= bs < 64
+    const int ws = ( du >= 0 ? du / 64 : -( ( -du + 63 ) / 64 ) ), bs = du - 64 * ws;
+    for( int i = 0; i < n; i++ ) {
+        int j = i - ws;
+        std::uint64_t w = ( 0 <= j && j < n ? src[ j ] << bs : 0 );
+        if( bs != 0 && 0 <= j - 1 && j - 1 < n ) {
+            w |= src[ j - 1 ] >> ( 64 - bs );
+        }
+        dst[ i ] |= w;
+    }
+}
+
+/**
+ * @fn expand
+ * @brief a next level of BFS
+ * @param [in] frontier states of a current level
+ * @param [in] visited states of all the levels so far
+ * @param [in] shifts shifts of actions, forward or backward
+ * @return states of a next level
+ * @details
+ */
+bitplanes expand( const bitplanes& frontier, const bitplanes& visited, const std::vector< shift >& shifts ) {
+    bitplanes next;
+    for( const auto& a : shifts ) {
+        for( int v = std::max( 0, a.dv ); v < std::min( v_num, v_num + a.dv ); v++ ) {
+            shift_or( next.row( a.q_next, v ), frontier.row( a.q, v - a.dv ), a.du );
+        }
+    }
+    //  Remove visited states and bits beyond u_num
+    const std::uint64_t tail_mask =
+        ( u_num % 64 == 0 ? ~std::uint64_t( 0 ) : ( std::uint64_t( 1 ) << ( u_num % 64 ) ) - 1 );
+    for( std::size_t i = 0; i < next.words.size( ); i++ ) {
+        next.words[ i ] &= ~visited.words[ i ];
+        if( i % row_words == ( std::size_t ) row_words - 1 ) {
+            next.words[ i ] &= tail_mask;
+        }
+    }
+    return next;
+}
+
+/**
+ * @fn unite
+ * @brief add states of a frontier to a visited set
+ * @param [in,out] visited a visited set
+ * @param [in] frontier a frontier
+ * @details
+ */
+void unite( bitplanes& visited, const bitplanes& frontier ) {
+    for( std::size_t i = 0; i < visited.words.size( ); i++ ) {
+        visited.words[ i ] |= frontier.words[ i ];
+    }
+}
+
+/**
+ * @fn reverse_shifts
+ * @brief shifts of backward actions, from q' to q with ( -du, -dv )
+ * @param [in] shifts shifts of forward actions
+ * @return shifts of backward actions
+ * @details
+ */
+std::vector< shift > reverse_shifts( const std::vector< shift >& shifts ) {
+    std::vector< shift > r;
+    for( const auto& a : shifts ) {
+        r.push_back( { a.q_next, a.q, -a.du, -a.dv } );
+    }
+    return r;
+}
+
+/**
+ * @fn reachable
+ * @brief states which can reach a goal state within n steps
+ * @param [in] g_state a goal state
+ * @param [in] n the number of steps
+ * @param [in] shifts shifts of forward actions
+ * @return states as bitplanes
+ * @details BFS of backward actions from a goal state
+ */
+bitplanes reachable( const state& g_state, int n, const std::vector< shift >& shifts ) {
+    const auto backward = reverse_shifts( shifts );
+    bitplanes frontier, visited;
+    frontier.set( g_state );
+    visited.set( g_state );
+    for( int level = 0; level < n && frontier.any( ); level++ ) {
+        frontier = expand( frontier, visited, backward );
+        unite( visited, frontier );
+    }
+    return visited;
+}
+
+int main( ) {
+    const auto shifts = make_shifts( );
+
+    //  Start: s_state, Goal: g_state
+    const state s_state( -2.484, 0.000, -90.0 ), g_state( -1.242, -0.600, 0.0 );
+
+    //  BFS, ( frontier, visited ) is saved at every K levels
+    std::vector< std::pair< bitplanes, bitplanes > > checkpoints;
+    bitplanes frontier, visited;
+    frontier.set( s_state );
+    visited.set( s_state );
+    int level = 0;
+    while( !frontier.test( g_state ) ) {
+        if( !frontier.any( ) ) {
+            std::cerr << "Goal is not reachable" << std::endl;
+            return 1;
+        }
+        if( level % K == 0 ) {
+            checkpoints.push_back( { frontier, visited } );
+        }
+        frontier = expand( frontier, visited, shifts );
+        unite( visited, frontier );
+        level++;
+    }
+    std::cerr << "Arrived at goal in steps of " << level << std::endl;
+
+    //  Find a path of states backward, frontiers of levels are recovered from a checkpoint
+    //  No checkpoint is saved if start is goal, and a path is only goal
+    std::vector< state > path_state = { g_state };
+    for( int k = ( level - 1 ) / K; level > 0 && k >= 0; k-- ) {
+        //  frontiers.at( i ) is a frontier of level k * K + i
+        std::vector< bitplanes > frontiers = { checkpoints.at( k ).first };
+        bitplanes visited_k = checkpoints.at( k ).second;
+        for( int l = k * K + 1; l < std::min( level, ( k + 1 ) * K ); l++ ) {
+            frontiers.push_back( expand( frontiers.back( ), visited_k, shifts ) );
+            unite( visited_k, frontiers.back( ) );
+        }
+        for( int l = ( int ) frontiers.size( ) - 1; l >= 0; l-- ) {
+            const state& c_state = path_state.back( );
+            //  A previous state in the frontier of a previous level
+            for( const auto& a : shifts ) {
+                state p_state( c_state.u - a.du, c_state.v - a.dv, a.q );
+                if( a.q_next == c_state.q && 0 <= p_state.u && p_state.u < u_num && 0 <= p_state.v &&
+                    p_state.v < v_num && frontiers.at( l ).test( p_state ) ) {
+                    path_state.push_back( p_state );
+                    break;
+                }
+            }
+            assert( ( int ) path_state.size( ) == level - ( k * K + l ) + 1 );
+        }
+    }
+    std::reverse( path_state.begin( ), path_state.end( ) );
+
+    //  States which can reach goal within the same steps
+    std::cerr << "States reaching goal in steps of " << level << ": " << reachable( g_state, level, shifts ).count( )
+              << std::endl;
+
+    //  Find a path of positions and orientations
+    for( const auto& s : path_state ) {
+        auto [ u, v, q ] = s.value( );
+        std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << V << " " << q << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,641 @@
+/**
+ * @file iwata-07.cpp
+ * @brief Resident planner service on a Unix domain socket
+ * @date 2026-10-18
+ * @copyright MIT License
+ * @details Motion tables of grids and lattice buffers of workers are kept resident across requests,
+ *          so that a latency of a request is bounded by its search, not by its setup.
+ *          Usage:
+ *              a.out serve  [socket] [workers]   run a planner service with workers, 1 by default
+ *              a.out client [socket]             plan a lap of 8 legs concurrently
+ *              a.out stats  [socket]             print counters of a planner service
+ *              a.out quit   [socket]             stop a planner service
+ *          Protocol, a request and a response per connection:
+ *              plan <grid id> <u> <v> <q> <u> <v> <q>  ->  ok <n> <actions> <error position> <error angle>,
+ *                                                          or error <message>
+ *              stats                                   ->  ok <n> and n lines of counters
+ *          actions are n digits of indices of W, "-" if n is 0, and an error is of an end pose
+ *          which is re-simulated continuously from a start pose. A client re-simulates actions to get a path.
+ *              quit                                    ->  ok 0
+ * */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+/**
+ * @fn deg2rad
+ * @brief convert from degree to radian
+ * @param [in] deg an angle in degree
+ * @return rad
+ * @details
+ */
+double deg2rad( double deg ) { return M_PI * deg / 180.0; }
+
+//  Parameters of robot velocity
+//  Simulation parameters
+const double dT = 0.1;
+//  Robot translational velocity [m/s]
+const double V = 0.1;
+//  Robot rotational velocity [rad/s]
+const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
+
+//  Course, range of u-position [ 0, 7.2 ] and v-position [ -1.2, 1.2 ]
+const std::pair< double, double > u_range = { 0.000, 7.200 }, v_range = { -1.200, 1.200 };
+
+//  Default socket
+const std::string default_socket = "/tmp/iwata-07.sock";
+//  Deadline of a whole connection in seconds, and the maximum length of a request line
+const int timeout_sec = 1;
+const std::size_t max_line = 256;
+
+//  Unvisited cost in steps
+const std::uint16_t UNVISITED = 0xffff;
+
+//  { Start, Goal } of a lap
+using uvq = std::tuple< double, double, double >;
+const std::vector< std::pair< uvq, uvq > > starts_goals_uvq = {
+    { { 1.863, 0.000, deg2rad( 270.0 ) }, { 2.484, -0.600, deg2rad( 0.0 ) } },
+    { { 2.484, -0.600, deg2rad( 0.0 ) }, { 3.726, 0.000, deg2rad( 30.0 ) } },
+    { { 3.726, 0.000, deg2rad( 30.0 ) }, { 4.968, 0.600, deg2rad( 0.0 ) } },
+    { { 4.968, 0.600, deg2rad( 0.0 ) }, { 5.589, 0.000, deg2rad( 270.0 ) } },
+    { { 5.589, 0.000, deg2rad( 270.0 ) }, { 4.968, -0.600, deg2rad( 180.0 ) } },
+    { { 4.968, -0.600, deg2rad( 180.0 ) }, { 3.726, 0.000, deg2rad( 150.0 ) } },
+    { { 3.726, 0.000, deg2rad( 150.0 ) }, { 2.484, 0.600, deg2rad( 180.0 ) } },
+    { { 2.484, 0.600, deg2rad( 180.0 ) }, { 1.863, 0.000, deg2rad( 270.0 ) } } };
+
+/**
+ * @fn resimulate
+ * @brief simulate actions continuously from a start pose
+ * @param [in] start a start pose
+ * @param [in] actions indices of W
+ * @return poses after every action, the first of which is a start pose
+ * @details the same simulation as iwata-03
+ */
+std::vector< uvq > resimulate( const uvq& start, const std::vector< int >& actions ) {
+    const std::size_t n = actions.size( );
+    auto [ u_start, v_start, q_start ] = start;
+    std::vector< double > q( n + 1, q_start ), u( n + 1, u_start ), v( n + 1, v_start );
+    std::transform( actions.begin( ), actions.end( ), q.begin( ) + 1, []( int a ) { return W.at( a ) * dT; } );
+    std::partial_sum( q.begin( ), q.end( ), q.begin( ) );
+    for( std::size_t k = 0; k < n; k++ ) {
+        u[ k + 1 ] = V * dT * std::cos( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+        v[ k + 1 ] = V * dT * std::sin( ( q[ k ] + q[ k + 1 ] ) / 2.0 );
+    }
+    std::partial_sum( u.begin( ), u.end( ), u.begin( ) );
+    std::partial_sum( v.begin( ), v.end( ), v.begin( ) );
+
+    std::vector< uvq > poses( n + 1 );
+    for( std::size_t k = 0; k <= n; k++ ) {
+        poses[ k ] = uvq( u[ k ], v[ k ], q[ k ] );
+    }
+    return poses;
+}
+
+/**
+ * @struct grid
+ * @brief a grid of the course and its motion table
+ * @details a cell ( u_id, v_id ) is centred at ( u_id * d_u + u_range.first, v_id * d_v + v_range.first ),
+ *          and q_id is centred at q_id * d_q
+ */
+struct grid {
+    double d_u, d_v, d_q;
+    int u_size, v_size, q_size;
+    //  Motion table indexed by q_id * W.size( ) + action, ( du, dv, q_id_next )
+    std::vector< std::tuple< int, int, int > > motions;
+    //  Previous q_id indexed by q_id * W.size( ) + action
+    std::vector< int > prev_q;
+
+    grid( double _d_u, double _d_v, double _d_q ) : d_u( _d_u ), d_v( _d_v ), d_q( _d_q ) {
+        u_size = ( int ) std::floor( ( u_range.second - u_range.first ) / d_u + 0.5 ) + 1;
+        v_size = ( int ) std::floor( ( v_range.second - v_range.first ) / d_v + 0.5 ) + 1;
+        q_size = ( int ) std::floor( 2.0 * M_PI / d_q + 0.5 );
+        prev_q.assign( q_size * W.size( ), -1 );
+        for( int q = 0; q < q_size; q++ ) {
+            for( std::size_t a = 0; a < W.size( ); a++ ) {
+                double q_curr = q * d_q, q_next = q_curr + W.at( a ) * dT;
+                int du = ( int ) std::floor( 0.5 + V * dT * std::cos( ( q_curr + q_next ) / 2.0 ) / d_u );
+                int dv = ( int ) std::floor( 0.5 + V * dT * std::sin( ( q_curr + q_next ) / 2.0 ) / d_v );
+                int q_id_next = q_id( q_next );
+                motions.push_back( { du, dv, q_id_next } );
+                prev_q.at( q_id_next * W.size( ) + a ) = q;
+            }
+        }
+    }
+    std::size_t size( ) const { return ( std::size_t ) u_size * v_size * q_size; }
+    //  A pose in the course with a heading in [ -4 pi, 4 pi ], which is checked before it is converted to ids
+    bool contains( double u, double v, double q ) const {
+        return std::abs( q ) <= 4.0 * M_PI && u_range.first - d_u / 2.0 <= u && u < u_range.second + d_u / 2.0 &&
+               v_range.first - d_v / 2.0 <= v && v < v_range.second + d_v / 2.0;
+    }
+    int u_id( double u ) const { return ( int ) std::floor( ( u - u_range.first ) / d_u + 0.5 ); }
+    int v_id( double v ) const { return ( int ) std::floor( ( v - v_range.first ) / d_v + 0.5 ); }
+    int q_id( double q ) const { return ( ( ( int ) std::floor( q / d_q + 0.5 ) % q_size ) + q_size ) % q_size; }
+    double u_val( int u_id ) const { return u_id * d_u + u_range.first; }
+    double v_val( int v_id ) const { return v_id * d_v + v_range.first; }
+    double q_val( int q_id ) const { return q_id * d_q; }
+    std::uint32_t flat_id( int u_id, int v_id, int q_id ) const { return ( u_id * v_size + v_id ) * q_size + q_id; }
+};
+
+//  Grids by id, 0: fast, 1: precise
+const std::vector< std::tuple< double, double, double > > grid_params = {
+    { 0.010, 0.010, M_PI / 60.0 }, { 0.005, 0.005, M_PI / 60.0 } };
+
+/**
+ * @struct lattice
+ * @brief search buffers of a worker on a grid
+ * @details only touched states are reset after a search.
+ *          Every buffer is touched on construction, so that a first search does not fault pages in.
+ */
+struct lattice {
+    //  Cost in steps
+    std::vector< std::uint16_t > cost;
+    //  Action taken to arrive at a state
+    std::vector< std::uint8_t > action;
+    //  FIFO queue of BFS, which is also a list of touched states
+    std::vector< std::uint32_t > que;
+    explicit lattice( std::size_t n ) : cost( n, UNVISITED ), action( n, 0 ), que( n, 0 ) { que.clear( ); }
+    void reset( ) {
+        for( auto id : que ) {
+            cost[ id ] = UNVISITED;
+        }
+        que.clear( );
+    }
+};
+
+//  Counters of a planner service
+struct counters {
+    std::atomic< long > requests{ 0 }, plans{ 0 }, errors{ 0 }, states_searched{ 0 };
+    std::atomic< long > search_usec{ 0 }, setup_usec{ 0 };
+};
+
+/**
+ * @fn plan
+ * @brief BFS from start to goal on a grid
+ * @param [in] g a grid
+ * @param [in,out] l lattice buffers of g, which are reset on return
+ * @param [in] start, goal poses
+ * @param [out] actions indices of W from start to goal
+ * @return the number of searched states, or -1 if goal is not reached
+ * @details every action costs a step, so that BFS is the same as Dijkstra's search.
+ *          start and goal have to be contained in g.
+ */
+long plan( const grid& g, lattice& l, const uvq& start, const uvq& goal, std::vector< int >& actions ) {
+    auto [ u_s, v_s, q_s ] = start;
+    auto [ u_g, v_g, q_g ] = goal;
+    int u_id_s = g.u_id( u_s ), v_id_s = g.v_id( v_s ), u_id_g = g.u_id( u_g ), v_id_g = g.v_id( v_g );
+    assert( 0 <= u_id_s && u_id_s < g.u_size && 0 <= v_id_s && v_id_s < g.v_size );
+    assert( 0 <= u_id_g && u_id_g < g.u_size && 0 <= v_id_g && v_id_g < g.v_size );
+    const std::uint32_t s_id = g.flat_id( u_id_s, v_id_s, g.q_id( q_s ) );
+    const std::uint32_t g_id = g.flat_id( u_id_g, v_id_g, g.q_id( q_g ) );
+
+    l.que.push_back( s_id );
+    l.cost[ s_id ] = 0;
+    bool is_goal_arrived = false;
+    for( std::size_t head = 0; head < l.que.size( ); head++ ) {
+        std::uint32_t id = l.que[ head ];
+        if( id == g_id ) {
+            is_goal_arrived = true;
+            break;
+        }
+        int q = id % g.q_size, v = ( id / g.q_size ) % g.v_size, u = id / g.q_size / g.v_size;
+        for( std::size_t a = 0; a < W.size( ); a++ ) {
+            auto [ du, dv, q_next ] = g.motions[ q * W.size( ) + a ];
+            int u_next = u + du, v_next = v + dv;
+            //  Out of workspace
+            if( !( 0 <= u_next && u_next < g.u_size && 0 <= v_next && v_next < g.v_size ) ) {
+                continue;
+            }
+            std::uint32_t n_id = g.flat_id( u_next, v_next, q_next );
+            if( l.cost[ n_id ] == UNVISITED ) {
+                l.cost[ n_id ] = l.cost[ id ] + 1;
+                l.action[ n_id ] = ( std::uint8_t ) a;
+                l.que.push_back( n_id );
+            }
+        }
+    }
+
+    //  Retrieve actions backward, a previous state is found by inverting an action
+    actions.clear( );
+    if( is_goal_arrived ) {
+        for( std::uint32_t id = g_id; id != s_id; ) {
+            int q = id % g.q_size, v = ( id / g.q_size ) % g.v_size, u = id / g.q_size / g.v_size;
+            int a = l.action[ id ], q_prev = g.prev_q[ q * W.size( ) + a ];
+            auto [ du, dv, q_next ] = g.motions[ q_prev * W.size( ) + a ];
+            actions.push_back( a );
+            id = g.flat_id( u - du, v - dv, q_prev );
+        }
+        std::reverse( actions.begin( ), actions.end( ) );
+    }
+    long num_searched = ( long ) l.que.size( );
+    l.reset( );
+    return is_goal_arrived ? num_searched : -1;
+}
+
+/**
+ * @struct connection
+ * @brief lines and strings on a socket before a deadline of the connection
+ * @details a socket is read in blocks, and bytes after a line are kept for a next line.
+ *          A deadline bounds a whole connection, not each recv or send.
+ */
+struct connection {
+    using clock = std::chrono::steady_clock;
+    int fd;
+    clock::time_point deadline;
+    std::string buffer;
+    explicit connection( int _fd, clock::time_point _deadline = clock::time_point::max( ) )
+        : fd( _fd ), deadline( _deadline ) {}
+
+    /**
+     * @fn wait
+     * @brief wait for a socket to be ready before a deadline
+     * @param [in] events POLLIN or POLLOUT
+     * @return true if it is ready
+     * @details
+     */
+    bool wait( short events ) const {
+        int timeout_msec = -1;
+        if( deadline != clock::time_point::max( ) ) {
+            auto rest = std::chrono::duration_cast< std::chrono::milliseconds >( deadline - clock::now( ) ).count( );
+            if( rest <= 0 ) {
+                return false;
+            }
+            timeout_msec = ( int ) rest;
+        }
+        pollfd p = { fd, events, 0 };
+        return poll( &p, 1, timeout_msec ) == 1;
+    }
+
+    /**
+     * @fn read_line
+     * @brief read a line
+     * @param [out] line a line without a newline
+     * @param [in] max_size the maximum length of a line, or 0 for no limit
+     * @return true if a line is read
+     * @details a line fails if it is longer than max_size, or if a deadline passes
+     */
+    bool read_line( std::string& line, std::size_t max_size = 0 ) {
+        line.clear( );
+        while( true ) {
+            std::size_t pos = buffer.find( '\n' );
+            if( pos != std::string::npos ) {
+                line = buffer.substr( 0, pos );
+                buffer.erase( 0, pos + 1 );
+                return max_size == 0 || line.size( ) <= max_size;
+            }
+            if( ( max_size != 0 && buffer.size( ) > max_size ) || !wait( POLLIN ) ) {
+                return false;
+            }
+            char block[ 512 ];
+            ssize_t r = recv( fd, block, sizeof( block ), 0 );
+            if( r <= 0 ) {
+                //  A last line without a newline
+                line.swap( buffer );
+                return r == 0 && !line.empty( ) && ( max_size == 0 || line.size( ) <= max_size );
+            }
+            buffer.append( block, r );
+        }
+    }
+
+    /**
+     * @fn write_all
+     * @brief write a string
+     * @param [in] s a string
+     * @return true if all of it is written
+     * @details
+     */
+    bool write_all( const std::string& s ) const {
+        for( std::size_t n = 0; n < s.size( ); ) {
+            if( !wait( POLLOUT ) ) {
+                return false;
+            }
+            ssize_t r = send( fd, s.data( ) + n, s.size( ) - n, MSG_NOSIGNAL | MSG_DONTWAIT );
+            if( r <= 0 ) {
+                return false;
+            }
+            n += r;
+        }
+        return true;
+    }
+};
+
+/**
+ * @fn unix_address
+ * @brief an address of a Unix domain socket
+ * @param [in] path a path of a socket
+ * @return an address
+ * @details
+ */
+sockaddr_un unix_address( const std::string& path ) {
+    sockaddr_un addr;
+    std::memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    std::strncpy( addr.sun_path, path.c_str( ), sizeof( addr.sun_path ) - 1 );
+    return addr;
+}
+
+/**
+ * @fn is_serving
+ * @brief check if a planner service listens on a socket
+ * @param [in] socket_path a path of a socket
+ * @return true if a connection is accepted
+ * @details
+ */
+bool is_serving( const std::string& socket_path ) {
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    sockaddr_un addr = unix_address( socket_path );
+    bool is_connected = ( fd >= 0 && connect( fd, ( sockaddr* ) &addr, sizeof( addr ) ) == 0 );
+    if( fd >= 0 ) {
+        close( fd );
+    }
+    return is_connected;
+}
+
+/**
+ * @fn request
+ * @brief send a request to a planner service and receive a response
+ * @param [in] socket_path a path of a socket
+ * @param [in] req a request line
+ * @param [out] lines lines of a response after its status line
+ * @return a status line, or an empty string if it fails to connect
+ * @details lines follow a status line of "ok <n>" without anything after n
+ */
+std::string request( const std::string& socket_path, const std::string& req, std::vector< std::string >& lines ) {
+    lines.clear( );
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    sockaddr_un addr = unix_address( socket_path );
+    std::string status;
+    connection conn( fd );
+    if( fd >= 0 && connect( fd, ( sockaddr* ) &addr, sizeof( addr ) ) == 0 && conn.write_all( req + "\n" ) &&
+        conn.read_line( status ) ) {
+        std::istringstream iss( status );
+        std::string ok, payload;
+        std::size_t n = 0;
+        if( iss >> ok >> n && ok == "ok" && !( iss >> payload ) ) {
+            std::string line;
+            while( lines.size( ) < n && conn.read_line( line ) ) {
+                lines.push_back( line );
+            }
+        }
+    }
+    if( fd >= 0 ) {
+        close( fd );
+    }
+    return status;
+}
+
+/**
+ * @fn serve
+ * @brief run a planner service until a quit request
+ * @param [in] socket_path a path of a socket
+ * @param [in] num_workers the number of workers
+ * @return exit status
+ * @details a worker owns lattice buffers of each grid, which are allocated before listening
+ */
+int serve( const std::string& socket_path, int num_workers ) {
+    //  A socket of a running service is not taken over, only a stale one is removed
+    if( is_serving( socket_path ) ) {
+        std::cerr << "A planner service is already running on " << socket_path << std::endl;
+        return 1;
+    }
+
+    //  Resident grids, motion tables and lattice buffers of workers
+    auto time_begin = std::chrono::steady_clock::now( );
+    std::vector< grid > grids;
+    for( const auto& [ d_u, d_v, d_q ] : grid_params ) {
+        grids.emplace_back( d_u, d_v, d_q );
+    }
+    std::vector< std::vector< std::unique_ptr< lattice > > > lattices( num_workers );
+    std::size_t bytes = 0;
+    for( auto& ls : lattices ) {
+        for( const auto& g : grids ) {
+            ls.push_back( std::make_unique< lattice >( g.size( ) ) );
+            bytes += g.size( ) * ( sizeof( std::uint16_t ) + sizeof( std::uint8_t ) + sizeof( std::uint32_t ) );
+        }
+    }
+    counters c;
+    c.setup_usec += std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now( ) -
+                                                                             time_begin )
+                        .count( );
+
+    int listen_fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    sockaddr_un addr = unix_address( socket_path );
+    unlink( socket_path.c_str( ) );
+    if( listen_fd < 0 || bind( listen_fd, ( sockaddr* ) &addr, sizeof( addr ) ) != 0 || listen( listen_fd, 64 ) != 0 ) {
+        std::cerr << "Failed to listen on " << socket_path << ": " << std::strerror( errno ) << std::endl;
+        return 1;
+    }
+
+    //  Connections waiting for a worker
+    std::deque< int > pending;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic< bool > is_quit( false );
+
+    auto handle = [ & ]( int fd, std::vector< std::unique_ptr< lattice > >& lattices ) {
+        c.requests++;
+        //  A deadline of a whole connection starts when a worker takes it
+        connection conn( fd, std::chrono::steady_clock::now( ) + std::chrono::seconds( timeout_sec ) );
+        std::string line;
+        std::ostringstream oss;
+        if( !conn.read_line( line, max_line ) ) {
+            c.errors++;
+            conn.write_all( "error bad request\n" );
+            close( fd );
+            return;
+        }
+        std::istringstream iss( line );
+        std::string cmd;
+        iss >> cmd;
+        if( cmd == "plan" ) {
+            std::size_t grid_id;
+            double u_s, v_s, q_s, u_g, v_g, q_g;
+            if( !( iss >> grid_id >> u_s >> v_s >> q_s >> u_g >> v_g >> q_g ) || grid_id >= grids.size( ) ) {
+                c.errors++;
+                oss << "error bad request" << std::endl;
+            } else if( !grids.at( grid_id ).contains( u_s, v_s, q_s ) ||
+                       !grids.at( grid_id ).contains( u_g, v_g, q_g ) ) {
+                c.errors++;
+                oss << "error pose out of course" << std::endl;
+            } else {
+                const grid& g = grids.at( grid_id );
+                auto time_begin = std::chrono::steady_clock::now( );
+                std::vector< int > actions;
+                long num_searched = plan( g, *lattices.at( grid_id ), { u_s, v_s, q_s }, { u_g, v_g, q_g }, actions );
+                c.search_usec += std::chrono::duration_cast< std::chrono::microseconds >(
+                                     std::chrono::steady_clock::now( ) - time_begin )
+                                     .count( );
+                if( num_searched < 0 ) {
+                    c.errors++;
+                    oss << "error goal is not reached" << std::endl;
+                } else {
+                    c.plans++;
+                    c.states_searched += num_searched;
+                    auto [ u_end, v_end, q_end ] = resimulate( { u_s, v_s, q_s }, actions ).back( );
+                    oss << "ok " << actions.size( ) << " ";
+                    for( auto a : actions ) {
+                        oss << a;
+                    }
+                    oss << ( actions.empty( ) ? "- " : " " ) << std::fixed << std::setprecision( 4 )
+                        << std::hypot( u_end - u_g, v_end - v_g ) << " "
+                        << std::fabs( std::remainder( q_end - q_g, 2.0 * M_PI ) ) << std::endl;
+                }
+            }
+        } else if( cmd == "stats" ) {
+            oss << "ok 6" << std::endl
+                << "requests " << c.requests << std::endl
+                << "plans " << c.plans << std::endl
+                << "errors " << c.errors << std::endl
+                << "states_searched " << c.states_searched << std::endl
+                << "search_usec " << c.search_usec << std::endl
+                << "setup_usec " << c.setup_usec << std::endl;
+        } else if( cmd == "quit" ) {
+            oss << "ok 0" << std::endl;
+            is_quit = true;
+            shutdown( listen_fd, SHUT_RDWR );
+        } else {
+            c.errors++;
+            oss << "error unknown request" << std::endl;
+        }
+        conn.write_all( oss.str( ) );
+        close( fd );
+    };
+
+    //  Worker pool
+    std::vector< std::thread > workers;
+    for( int t = 0; t < num_workers; t++ ) {
+        workers.emplace_back( [ &, t ]( ) {
+            while( true ) {
+                std::unique_lock< std::mutex > lock( mtx );
+                cv.wait( lock, [ & ]( ) { return is_quit || !pending.empty( ); } );
+                if( pending.empty( ) ) {
+                    return;
+                }
+                int fd = pending.front( );
+                pending.pop_front( );
+                lock.unlock( );
+                handle( fd, lattices.at( t ) );
+            }
+        } );
+    }
+    std::cerr << "Serving on " << socket_path << " with " << num_workers << " workers, " << ( bytes >> 20 )
+              << " [MiB] of lattices" << std::endl;
+
+    //  Accept connections until a quit request
+    while( !is_quit ) {
+        int fd = accept( listen_fd, nullptr, nullptr );
+        if( fd < 0 ) {
+            continue;
+        }
+        std::lock_guard< std::mutex > lock( mtx );
+        pending.push_back( fd );
+        cv.notify_one( );
+    }
+    {
+        std::lock_guard< std::mutex > lock( mtx );
+        cv.notify_all( );
+    }
+    for( auto& w : workers ) {
+        w.join( );
+    }
+    close( listen_fd );
+    unlink( socket_path.c_str( ) );
+    return 0;
+}
+
+/**
+ * @fn client
+ * @brief plan a lap of legs concurrently and print paths
+ * @param [in] socket_path a path of a socket
+ * @return exit status
+ * @details a path is re-simulated from actions of a response, and paths of legs are separated by a blank line
+ */
+int client( const std::string& socket_path ) {
+    std::vector< std::vector< std::string > > lines( starts_goals_uvq.size( ) );
+    std::vector< std::string > statuses( starts_goals_uvq.size( ) );
+    std::vector< double > msecs( starts_goals_uvq.size( ) );
+    std::vector< std::thread > threads;
+    for( std::size_t k = 0; k < starts_goals_uvq.size( ); k++ ) {
+        threads.emplace_back( [ &, k ]( ) {
+            auto [ start_uvq, goal_uvq ] = starts_goals_uvq.at( k );
+            auto [ u_s, v_s, q_s ] = start_uvq;
+            auto [ u_g, v_g, q_g ] = goal_uvq;
+            std::ostringstream oss;
+            oss << std::setprecision( 17 ) << "plan 0 " << u_s << " " << v_s << " " << q_s << " " << u_g << " " << v_g
+                << " " << q_g;
+            auto time_begin = std::chrono::steady_clock::now( );
+            statuses.at( k ) = request( socket_path, oss.str( ), lines.at( k ) );
+            msecs.at( k ) =
+                std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now( ) - time_begin ).count( );
+        } );
+    }
+    for( auto& th : threads ) {
+        th.join( );
+    }
+
+    int status = 0;
+    for( std::size_t k = 0; k < starts_goals_uvq.size( ); k++ ) {
+        std::cerr << "leg " << k + 1 << ": " << statuses.at( k ) << ", " << std::fixed << std::setprecision( 3 )
+                  << msecs.at( k ) << " [ms]" << std::endl;
+        //  ok <n> <actions> <error position> <error angle>
+        std::istringstream iss( statuses.at( k ) );
+        std::string ok, digits;
+        std::size_t n = 0;
+        if( !( iss >> ok >> n >> digits ) || ok != "ok" || ( n > 0 && digits.size( ) != n ) ) {
+            status = 1;
+            continue;
+        }
+        std::vector< int > actions;
+        for( std::size_t i = 0; i < n; i++ ) {
+            actions.push_back( digits.at( i ) - '0' );
+        }
+        for( const auto& [ u, v, q ] : resimulate( starts_goals_uvq.at( k ).first, actions ) ) {
+            std::cout << std::fixed << std::setprecision( 3 ) << u << " " << v << " " << q << " " << V << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    return status;
+}
+
+int main( int argc, char* argv[] ) {
+    const std::string mode = ( argc > 1 ? argv[ 1 ] : "serve" );
+    const std::string socket_path = ( argc > 2 ? argv[ 2 ] : default_socket );
+
+    if( mode == "serve" ) {
+        const int num_workers = ( argc > 3 ? std::max( 1, std::stoi( argv[ 3 ] ) ) : 1 );
+        return serve( socket_path, num_workers );
+    } else if( mode == "client" ) {
+        return client( socket_path );
+    } else if( mode == "stats" || mode == "quit" ) {
+        std::vector< std::string > lines;
+        std::string status = request( socket_path, mode, lines );
+        std::cerr << ( status.empty( ) ? "Failed to connect to " + socket_path : status ) << std::endl;
+        for( const auto& line : lines ) {
+            std::cout << line << std::endl;
+        }
+        return status.rfind( "ok", 0 ) == 0 ? 0 : 1;
+    }
+    std::cerr << "Usage: " << argv[ 0 ] << " [ serve | client | stats | quit ] [ socket ] [ workers ]" << std::endl;
+    return 1;
+}
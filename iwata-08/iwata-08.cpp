@@ -0,0 +1,339 @@
+/**
+ * @file iwata-08.cpp
+ * @brief Resolution tuner of ( d_u, d_v, d_q )
+ * @date 2026-10-18
+ * @copyright MIT License
+ * @details Every leg of a course is searched on every grid of a sweep in parallel, by the same window and
+ *          the same search as iwata-03a, which reads a configuration and plans each leg on its grid.
+ *          Actions of a path are re-simulated continuously from a start pose, and an error of an end pose
+ *          is measured against a goal pose together with time and memory of a search.
+ *          The coarsest grid within a tolerance and a safety margin is written to a configuration file
+ *          for each leg. If no grid is, the finest grid is written and the exit status is 1.
+ *          Usage:
+ *              a.out [configuration] [tolerance] [memory]
+ *          configuration is tune.txt, a tolerance of an end position is 0.100 [m],
+ *          and memory of searches running at the same time is 2048 [MiB] by default
+ * */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+/**
+ * @fn deg2rad
+ * @brief convert from degree to radian
+ * @param [in] deg an angle in degree
+ * @return rad
+ * @details
+ */
+double deg2rad( double deg ) { return M_PI * deg / 180.0; }
+
+/**
+ * @fn rad2deg
+ * @brief convert from radian to degree
+ * @param [in] rad an angle in radian
+ * @return deg
+ * @details
+ */
+double rad2deg( double rad ) { return 180.0 * rad / M_PI; }
+
+//  Parameters of robot velocity
+//  Simulation parameters
+const double dT = 0.1;
+//  Robot translational velocity [m/s]
+const double V = 0.1;
+//  Robot rotational velocity [rad/s]
+const std::vector< double > W = { -deg2rad( 30.0 ), 0.0, deg2rad( 30.0 ) };
+
+//  Data Set
+//  Offset of u-range from a start and a goal, a turning radius
+const double offset_u = ( std::floor( V / deg2rad( 30.0 ) * 1000.0 ) + 1.0 ) / 1000.0;
+//  Range of v-position of the course [ v_min, v_max ]
+const std::pair< double, double > course_v = { -1.200, 1.200 };
+//  { Start, Goal }
+using uvq = std::tuple< double, double, double >;
+const std::vector< std::pair< uvq, uvq > > starts_goals_uvq = {
+    { { 1.863, 0.000, deg2rad( 270.0 ) }, { 2.484, -0.600, deg2rad( 0.0 ) } },
+    { { 2.484, -0.600, deg2rad( 0.0 ) }, { 3.726, 0.000, deg2rad( 30.0 ) } },
+    { { 3.726, 0.000, deg2rad( 30.0 ) }, { 4.968, 0.600, deg2rad( 0.0 ) } },
+    { { 4.968, 0.600, deg2rad( 0.0 ) }, { 5.589, 0.000, deg2rad( 270.0 ) } },
+    { { 5.589, 0.000, deg2rad( 270.0 ) }, { 4.968, -0.600, deg2rad( 180.0 ) } },
+    { { 4.968, -0.600, deg2rad( 180.0 ) }, { 3.726, 0.000, deg2rad( 150.0 ) } },
+    { { 3.726, 0.000, deg2rad( 150.0 ) }, { 2.484, 0.600, deg2rad( 180.0 ) } },
+    { { 2.484, 0.600, deg2rad( 180.0 ) }, { 1.863, 0.000, deg2rad( 270.0 ) } } };
+
+//  Sweep of grids, ( d_u, d_v, d_q ) from coarse to fine
+//  d_q is fixed at W * dT = 3 [deg], since every action turns by a multiple of it and a finer d_q
+//  cannot change a path, while a coarser d_q cannot represent a turn of an action
+using resolution = std::tuple< double, double, double >;
+const std::vector< resolution > sweep = { { 0.020, 0.020, M_PI / 60.0 },   { 0.010, 0.010, M_PI / 60.0 },
+                                          { 0.005, 0.005, M_PI / 60.0 },   { 0.0025, 0.0025, M_PI / 60.0 },
+                                          { 0.002, 0.002, M_PI / 60.0 } };
+
+//  Tolerance of an end angle [rad]
+const double tol_angle = deg2rad( 1.5 );
+//  Safety margin of a tolerance, an error has to be within ( 1 - margin ) * tolerance,
+//  so that a choice does not flip on errors of a few millimetres around a tolerance
+const double margin = 0.2;
+
+//  Unvisited cost in steps
+const std::uint16_t UNVISITED = 0xffff;
+
+/**
+ * @fn angle_diff
+ * @brief a difference of angles in [ -pi, pi )
+ * @param [in] a, b angles
+ * @return a - b
+ * @details
+ */
+double angle_diff( double a, double b ) {
+    double d = std::fmod( a - b + M_PI, 2.0 * M_PI );
+    return ( d < 0.0 ? d + 2.0 * M_PI : d ) - M_PI;
+}
+
+//  Conversions between a position and an id of iwata-03a, a cell [ x_min + id * d, x_min + ( id + 1 ) * d )
+int to_id( double x, double x_min, double d ) { return ( int ) std::floor( ( x - x_min ) / d ); }
+double to_val( int id, double x_min, double d ) { return ( double ) id * d + x_min + d / 2.0; }
+
+/**
+ * @struct window
+ * @brief a grid of a leg, which is the same as a window of iwata-03a
+ * @details u is around a leg by offset_u, v is the whole course, and a state is a flat id of
+ *          ( u_id * v_size + v_id ) * q_size + q_id
+ */
+struct window {
+    double d_u, d_v, d_q;
+    std::pair< double, double > u_range, v_range, q_range;
+    int u_size, v_size, q_size;
+    window( const uvq& start_uvq, const uvq& goal_uvq, const resolution& r ) {
+        std::tie( d_u, d_v, d_q ) = r;
+        auto [ start_u, start_v, start_q ] = start_uvq;
+        auto [ goal_u, goal_v, goal_q ] = goal_uvq;
+        double u_min = std::min( start_u, goal_u ) - offset_u, u_max = std::max( start_u, goal_u ) + offset_u;
+        u_range = { u_min - d_u / 2.0, u_max + 3.0 * d_u / 2.0 };
+        v_range = { course_v.first - d_v / 2.0, course_v.second + 3.0 * d_v / 2.0 };
+        q_range = { 0.0 - d_q / 2.0, 2.0 * M_PI - d_q / 2.0 };
+        u_size = to_id( u_range.second, u_range.first, d_u );
+        v_size = to_id( v_range.second, v_range.first, d_v );
+        q_size = to_id( q_range.second, q_range.first, d_q );
+    }
+    std::size_t size( ) const { return ( std::size_t ) u_size * v_size * q_size; }
+    std::uint32_t flat_id( int u, int v, int q ) const { return ( u * v_size + v ) * q_size + q; }
+};
+
+/**
+ * @struct result
+ * @brief a result of a leg on a grid
+ * @details
+ */
+struct result {
+    bool is_goal_arrived = false;
+    std::size_t num_actions = 0;
+    double err_position = INFINITY, err_angle = INFINITY;
+    double msec = 0.0;
+    //  Memory of tables of states, and a peak of a priority queue
+    std::size_t bytes_tables = 0, bytes_queue = 0;
+};
+
+/**
+ * @fn search
+ * @brief Dijkstra's search of a leg on a window, and re-simulation of its actions
+ * @param [in] w a window
+ * @param [in] start, goal poses
+ * @return a result
+ * @details the same search as iwata-03a, so that a path is the one iwata-03a takes on a window.
+ *          An action is recovered from headings of a state and its previous state.
+ */
+result search( const window& w, const uvq& start, const uvq& goal ) {
+    auto time_begin = std::chrono::steady_clock::now( );
+    auto [ u_s, v_s, q_s ] = start;
+    auto [ u_g, v_g, q_g ] = goal;
+    const double u_min = w.u_range.first, v_min = w.v_range.first, q_min = w.q_range.first;
+    const std::uint32_t s_id =
+        w.flat_id( to_id( u_s, u_min, w.d_u ), to_id( v_s, v_min, w.d_v ), to_id( q_s, q_min, w.d_q ) );
+    const std::uint32_t g_id =
+        w.flat_id( to_id( u_g, u_min, w.d_u ), to_id( v_g, v_min, w.d_v ), to_id( q_g, q_min, w.d_q ) );
+    //  A next heading of an action from q_id
+    auto q_id_next = [ & ]( int q_id, std::size_t a ) {
+        double q_next = to_val( q_id, q_min, w.d_q ) + W[ a ] * dT;
+        if( q_next < w.q_range.first ) {
+            q_next += 2.0 * M_PI;
+        } else if( w.q_range.second <= q_next ) {
+            q_next -= 2.0 * M_PI;
+        }
+        return to_id( q_next, q_min, w.d_q );
+    };
+
+    //  Cost in steps and a previous state, a priority queue of ( cost << 32 ) | id
+    const std::size_t n = w.size( );
+    std::vector< std::uint16_t > g_cost( n, UNVISITED );
+    std::vector< std::uint32_t > prev( n );
+    std::vector< std::uint64_t > heap = { s_id };
+    g_cost[ s_id ] = 0;
+    result r;
+    std::size_t heap_peak = 1;
+    while( !heap.empty( ) ) {
+        std::pop_heap( heap.begin( ), heap.end( ), std::greater< std::uint64_t >( ) );
+        const std::uint16_t t_curr = ( std::uint16_t )( heap.back( ) >> 32 );
+        const std::uint32_t id_curr = ( std::uint32_t )( heap.back( ) & 0xffffffffu );
+        heap.pop_back( );
+        if( id_curr == g_id ) {
+            r.is_goal_arrived = true;
+            break;
+        }
+        if( g_cost[ id_curr ] < t_curr ) {
+            continue;
+        }
+        int q_id_curr = id_curr % w.q_size, v_id_curr = ( id_curr / w.q_size ) % w.v_size,
+            u_id_curr = id_curr / w.q_size / w.v_size;
+        double u_curr = to_val( u_id_curr, u_min, w.d_u ), v_curr = to_val( v_id_curr, v_min, w.d_v ),
+               q_curr = to_val( q_id_curr, q_min, w.d_q );
+        for( std::size_t a = 0; a < W.size( ); a++ ) {
+            double q_next = q_curr + W[ a ] * dT;
+            if( q_next < w.q_range.first ) {
+                q_next += 2.0 * M_PI;
+            } else if( w.q_range.second <= q_next ) {
+                q_next -= 2.0 * M_PI;
+            }
+            double u_next = u_curr + V * dT * std::cos( ( q_next + q_curr ) / 2.0 );
+            double v_next = v_curr + V * dT * std::sin( ( q_next + q_curr ) / 2.0 );
+            int u_id_next = to_id( u_next, u_min, w.d_u ), v_id_next = to_id( v_next, v_min, w.d_v );
+            //  Out of workspace
+            if( !( 0 <= u_id_next && u_id_next < w.u_size && 0 <= v_id_next && v_id_next < w.v_size ) ) {
+                continue;
+            }
+            std::uint32_t id_next = w.flat_id( u_id_next, v_id_next, to_id( q_next, q_min, w.d_q ) );
+            if( g_cost[ id_next ] == UNVISITED || t_curr + 1 < g_cost[ id_next ] ) {
+                g_cost[ id_next ] = t_curr + 1;
+                prev[ id_next ] = id_curr;
+                heap.push_back( ( std::uint64_t( t_curr + 1 ) << 32 ) | id_next );
+                std::push_heap( heap.begin( ), heap.end( ), std::greater< std::uint64_t >( ) );
+                heap_peak = std::max( heap_peak, heap.size( ) );
+            }
+        }
+    }
+    r.bytes_tables = n * ( sizeof( std::uint16_t ) + sizeof( std::uint32_t ) );
+    r.bytes_queue = heap_peak * sizeof( std::uint64_t );
+    r.msec = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now( ) - time_begin ).count( );
+    if( !r.is_goal_arrived ) {
+        return r;
+    }
+
+    //  Retrieve actions backward, an action is the one which turns a previous heading to a heading
+    std::vector< std::size_t > actions;
+    for( std::uint32_t id = g_id; id != s_id; id = prev[ id ] ) {
+        std::size_t a = 0;
+        while( q_id_next( prev[ id ] % w.q_size, a ) != ( int ) ( id % w.q_size ) ) {
+            a++;
+        }
+        assert( a < W.size( ) );
+        actions.push_back( a );
+    }
+    std::reverse( actions.begin( ), actions.end( ) );
+    r.num_actions = actions.size( );
+
+    //  Re-simulation of actions from a start pose
+    double u = u_s, v = v_s, q = q_s;
+    for( auto a : actions ) {
+        double q_next = q + W.at( a ) * dT;
+        u += V * dT * std::cos( ( q + q_next ) / 2.0 );
+        v += V * dT * std::sin( ( q + q_next ) / 2.0 );
+        q = q_next;
+    }
+    r.err_position = std::hypot( u - u_g, v - v_g );
+    r.err_angle = std::fabs( angle_diff( q, q_g ) );
+    return r;
+}
+
+int main( int argc, char* argv[] ) {
+    const std::string config_path = ( argc > 1 ? argv[ 1 ] : "tune.txt" );
+    const double tol_position = ( argc > 2 ? std::stod( argv[ 2 ] ) : 0.100 );
+    const std::size_t budget = ( argc > 3 ? std::stoul( argv[ 3 ] ) : 2048 ) << 20;
+    const std::size_t num_legs = starts_goals_uvq.size( ), num_grids = sweep.size( );
+
+    //  Tasks of ( leg, grid ) are taken by worker threads within a memory budget.
+    //  A task takes its tables and at most a queue entry per state, and a task over a budget runs alone.
+    std::vector< result > results( num_legs * num_grids );
+    std::atomic< std::size_t > next_task( 0 );
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t bytes_running = 0;
+    const int num_threads = std::max( 1u, std::thread::hardware_concurrency( ) );
+    std::vector< std::thread > threads;
+    for( int t = 0; t < num_threads; t++ ) {
+        threads.emplace_back( [ & ]( ) {
+            for( std::size_t k = next_task++; k < results.size( ); k = next_task++ ) {
+                auto [ start_uvq, goal_uvq ] = starts_goals_uvq.at( k / num_grids );
+                const window w( start_uvq, goal_uvq, sweep.at( k % num_grids ) );
+                const std::size_t bytes =
+                    w.size( ) * ( sizeof( std::uint16_t ) + sizeof( std::uint32_t ) + sizeof( std::uint64_t ) );
+                {
+                    std::unique_lock< std::mutex > lock( mtx );
+                    cv.wait( lock, [ & ]( ) { return bytes_running == 0 || bytes_running + bytes <= budget; } );
+                    bytes_running += bytes;
+                }
+                results.at( k ) = search( w, start_uvq, goal_uvq );
+                {
+                    std::lock_guard< std::mutex > lock( mtx );
+                    bytes_running -= bytes;
+                }
+                cv.notify_all( );
+            }
+        } );
+    }
+    for( auto& th : threads ) {
+        th.join( );
+    }
+
+    //  The coarsest grid within a tolerance, which has the largest cell, for each leg
+    auto cell_volume = [ & ]( std::size_t k ) {
+        auto [ d_u, d_v, d_q ] = sweep.at( k );
+        return d_u * d_v * d_q;
+    };
+    std::ofstream ofs( config_path );
+    ofs << "#  tolerance " << tol_position << " [m] " << rad2deg( tol_angle ) << " [deg], margin " << margin
+        << std::endl;
+    ofs << "#  leg d_u d_v d_q" << std::endl;
+    int status = 0;
+    for( std::size_t leg = 0; leg < num_legs; leg++ ) {
+        std::size_t best = num_grids;
+        for( std::size_t k = 0; k < num_grids; k++ ) {
+            const result& r = results.at( leg * num_grids + k );
+            auto [ d_u, d_v, d_q ] = sweep.at( k );
+            std::cerr << std::fixed << std::setprecision( 5 ) << "leg " << leg + 1 << ", grid ( " << d_u << ", "
+                      << d_v << ", " << std::setprecision( 3 ) << rad2deg( d_q ) << " [deg] ): " << std::boolalpha
+                      << r.is_goal_arrived << ", actions " << r.num_actions << ", error " << r.err_position
+                      << " [m] " << rad2deg( r.err_angle ) << " [deg], " << r.msec << " [ms], tables "
+                      << r.bytes_tables / 1e6 << " [MB], queue " << r.bytes_queue / 1e6 << " [MB]" << std::endl;
+            if( r.is_goal_arrived && r.err_position <= ( 1.0 - margin ) * tol_position &&
+                r.err_angle <= ( 1.0 - margin ) * tol_angle &&
+                ( best == num_grids || cell_volume( k ) > cell_volume( best ) ) ) {
+                best = k;
+            }
+        }
+        if( best == num_grids ) {
+            std::cerr << "leg " << leg + 1 << ": no grid is within tolerance, the finest grid is taken" << std::endl;
+            best = num_grids - 1;
+            status = 1;
+        }
+        auto [ d_u, d_v, d_q ] = sweep.at( best );
+        ofs << leg + 1 << " " << d_u << " " << d_v << " " << std::setprecision( 17 ) << d_q << std::setprecision( 6 )
+            << std::endl;
+        std::cerr << std::setprecision( 5 ) << "leg " << leg + 1 << " -> ( " << d_u << ", " << d_v << ", "
+                  << std::setprecision( 3 ) << rad2deg( d_q ) << " [deg] )" << std::endl;
+    }
+
+    return status;
+}